@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+# Проверка update_base: база из make_base, обновленная update_base, должна отвечать на запросы так же,
+# как база, собранная make_base заново из base_requests с уже примененными update_requests.
+# Stop, Bus и Map сравниваются целиком. У Route сравнивается total_time, а у маршрута обновленной
+# базы - что время участков в сумме дает total_time: пересчитанные строки таблицы могут выбрать
+# другой путь того же времени.
+#
+# check_update_base.py transport_catalogue make_base.json update_requests.json process_requests.json
+#
+# Например, из корня репозитория:
+# example/check_update_base.py build/transport_catalogue example/test_2_make_base.json \
+#     example/test_2_update_requests.json example/test_2_process_requests.json
+
+import json
+import math
+import os
+import subprocess
+import sys
+import tempfile
+
+# время в ответе печатается с 6 значащими цифрами
+TIME_TOLERANCE = 1e-5
+
+
+def is_close(lhs, rhs):
+    return math.isclose(lhs, rhs, rel_tol=TIME_TOLERANCE, abs_tol=TIME_TOLERANCE)
+
+
+def apply_updates(base_requests, update_requests):
+    """base_requests после update_requests: замена на месте, новые в конец, удаление по remove"""
+    out = list(base_requests)
+    for update in update_requests:
+        index = next((i for i, request in enumerate(out)
+                      if request['type'] == update['type'] and request['name'] == update['name']), None)
+        if update.get('remove', False):
+            del out[index]
+            if update['type'] == 'Stop':
+                for request in out:
+                    if request['type'] == 'Stop':
+                        request.get('road_distances', {}).pop(update['name'], None)
+        elif index is None:
+            out.append(update)
+        else:
+            out[index] = update
+    return out
+
+
+def run(binary, mode, document):
+    result = subprocess.run([binary, mode], input=json.dumps(document), capture_output=True, text=True)
+    if result.returncode != 0:
+        sys.exit('%s failed: %s' % (mode, result.stderr))
+    return result.stdout
+
+
+def compare(expected, actual):
+    """список расхождений ответов actual с expected"""
+    out = []
+    if len(expected) != len(actual):
+        return ['%d answers instead of %d' % (len(actual), len(expected))]
+    for rebuilt, updated in zip(expected, actual):
+        request_id = rebuilt.get('request_id')
+        if 'total_time' not in rebuilt:
+            if rebuilt != updated:
+                out.append('request %s: answers differ' % request_id)
+            continue
+        if 'total_time' not in updated:
+            out.append('request %s: no route, expected %s' % (request_id, rebuilt['total_time']))
+            continue
+        if not is_close(rebuilt['total_time'], updated['total_time']):
+            out.append('request %s: total_time %s instead of %s' % (request_id, updated['total_time'], rebuilt['total_time']))
+        items_time = sum(item['time'] for item in updated['items'])
+        if not is_close(items_time, updated['total_time']):
+            out.append('request %s: items take %s, total_time %s' % (request_id, items_time, updated['total_time']))
+    return out
+
+
+def main():
+    if len(sys.argv) != 5:
+        sys.exit('usage: check_update_base.py transport_catalogue make_base.json update_requests.json process_requests.json')
+    binary = os.path.abspath(sys.argv[1])
+    with open(sys.argv[2]) as file:
+        make_base = json.load(file)
+    with open(sys.argv[3]) as file:
+        update = json.load(file)
+    with open(sys.argv[4]) as file:
+        process = json.load(file)
+
+    with tempfile.TemporaryDirectory() as directory:
+        updated_file = os.path.join(directory, 'updated.db')
+        rebuilt_file = os.path.join(directory, 'rebuilt.db')
+
+        make_base['serialization_settings']['file'] = updated_file
+        run(binary, 'make_base', make_base)
+        update['serialization_settings']['file'] = updated_file
+        run(binary, 'update_base', update)
+
+        make_base['serialization_settings']['file'] = rebuilt_file
+        make_base['base_requests'] = apply_updates(make_base['base_requests'], update['update_requests'])
+        run(binary, 'make_base', make_base)
+
+        process['serialization_settings']['file'] = rebuilt_file
+        expected = json.loads(run(binary, 'process_requests', process))
+        process['serialization_settings']['file'] = updated_file
+        actual = json.loads(run(binary, 'process_requests', process))
+
+    differences = compare(expected, actual)
+    for difference in differences:
+        print(difference)
+    print('%d answers, %d differences' % (len(expected), len(differences)))
+    sys.exit(1 if differences else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,268 @@
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "base_image.h"
+
+using namespace std::literals;
+
+namespace NS_TransportCatalogue::Serealization_Worker
+{
+
+namespace
+{
+
+constexpr char IMAGE_MAGIC[8] = {'T', 'C', 'B', 'I', 'M', 'A', 'G', 'E'};
+constexpr uint32_t IMAGE_VERSION = 1;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+// выравнивание секций образа, кратно размеру строки кэша
+constexpr uint64_t SECTION_ALIGNMENT = 64;
+
+struct ImageHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    uint64_t catalogue_offset;
+    uint64_t catalogue_size;
+    uint64_t has_routes;
+    uint64_t vertex_count;
+    uint64_t weights_offset;
+    uint64_t prev_edges_offset;
+};
+
+uint64_t AlignOffset(uint64_t offset)
+{
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+void WritePadding(std::ostream& output, uint64_t& offset, uint64_t aligned_offset)
+{
+    static constexpr char ZEROS[SECTION_ALIGNMENT] = {};
+    output.write(ZEROS, static_cast<std::streamsize>(aligned_offset - offset));
+    offset = aligned_offset;
+}
+
+void CheckSection(uint64_t offset, uint64_t size, size_t image_size)
+{
+    if (offset > image_size || size > image_size - offset)
+    {
+        throw std::runtime_error("base image error: section is out of file bounds");
+    }
+}
+
+} // end namespace
+
+// ======Class MappedFile===========
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& file)
+{
+    file_handle_ = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle_ == INVALID_HANDLE_VALUE)
+    {
+        file_handle_ = nullptr;
+        throw std::runtime_error("can't open file - "s + file.string());
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle_, &file_size))
+    {
+        CloseHandle(file_handle_);
+        throw std::runtime_error("can't read file size - "s + file.string());
+    }
+    size_ = static_cast<size_t>(file_size.QuadPart);
+    if (size_ == 0)
+    {
+        return;
+    }
+
+    mapping_handle_ = CreateFileMappingW(file_handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle_ == nullptr)
+    {
+        CloseHandle(file_handle_);
+        throw std::runtime_error("can't map file - "s + file.string());
+    }
+
+    data_ = static_cast<const char*>(MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr)
+    {
+        CloseHandle(mapping_handle_);
+        CloseHandle(file_handle_);
+        throw std::runtime_error("can't map file - "s + file.string());
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+    {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_handle_)
+    {
+        CloseHandle(mapping_handle_);
+    }
+    if (file_handle_)
+    {
+        CloseHandle(file_handle_);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& file)
+{
+    const int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("can't open file - "s + file.string());
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("can't read file size - "s + file.string());
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+
+    if (size_ != 0)
+    {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("can't map file - "s + file.string());
+        }
+        data_ = static_cast<const char*>(data);
+    }
+
+    // отображение остается действительным и после закрытия дескриптора
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+    {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+#endif
+
+const char* MappedFile::GetData() const
+{
+    return data_;
+}
+
+size_t MappedFile::GetSize() const
+{
+    return size_;
+}
+
+// ======Base image===========
+
+bool IsBaseImage(const char* data, size_t size)
+{
+    return size >= sizeof(IMAGE_MAGIC) && std::memcmp(data, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) == 0;
+}
+
+BaseImage ReadBaseImage(const char* data, size_t size)
+{
+    if (!IsBaseImage(data, size) || size < sizeof(ImageHeader))
+    {
+        throw std::runtime_error("base image error: bad header");
+    }
+
+    ImageHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (header.version != IMAGE_VERSION)
+    {
+        throw std::runtime_error("base image error: unsupported version " + std::to_string(header.version));
+    }
+    if (header.byte_order_mark != BYTE_ORDER_MARK)
+    {
+        throw std::runtime_error("base image error: image was written with another byte order");
+    }
+
+    BaseImage out;
+
+    CheckSection(header.catalogue_offset, header.catalogue_size, size);
+    out.catalogue = std::string_view(data + header.catalogue_offset, header.catalogue_size);
+
+    out.has_routes = header.has_routes != 0;
+    if (out.has_routes)
+    {
+        const uint64_t cell_count = header.vertex_count * header.vertex_count;
+        if (header.vertex_count != 0 && cell_count / header.vertex_count != header.vertex_count)
+        {
+            throw std::runtime_error("base image error: bad routes table size");
+        }
+        if (header.weights_offset % alignof(double) != 0 || header.prev_edges_offset % alignof(uint32_t) != 0)
+        {
+            throw std::runtime_error("base image error: routes table is not aligned");
+        }
+        CheckSection(header.weights_offset, cell_count * sizeof(double), size);
+        CheckSection(header.prev_edges_offset, cell_count * sizeof(uint32_t), size);
+
+        out.routes.vertex_count = header.vertex_count;
+        out.routes.weights = reinterpret_cast<const double*>(data + header.weights_offset);
+        out.routes.prev_edges = reinterpret_cast<const uint32_t*>(data + header.prev_edges_offset);
+    }
+
+    return out;
+}
+
+void WriteBaseImage(std::ostream& output, std::string_view catalogue, const BaseImageRoutes* routes)
+{
+    ImageHeader header{};
+    std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.version = IMAGE_VERSION;
+    header.byte_order_mark = BYTE_ORDER_MARK;
+
+    header.catalogue_offset = AlignOffset(sizeof(ImageHeader));
+    header.catalogue_size = catalogue.size();
+
+    const uint64_t cell_count = routes ? routes->vertex_count * routes->vertex_count : 0;
+    if (routes)
+    {
+        header.has_routes = 1;
+        header.vertex_count = routes->vertex_count;
+        header.weights_offset = AlignOffset(header.catalogue_offset + header.catalogue_size);
+        header.prev_edges_offset = AlignOffset(header.weights_offset + cell_count * sizeof(double));
+    }
+
+    uint64_t offset = sizeof(ImageHeader);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    WritePadding(output, offset, header.catalogue_offset);
+    output.write(catalogue.data(), static_cast<std::streamsize>(catalogue.size()));
+    offset += catalogue.size();
+
+    if (routes)
+    {
+        WritePadding(output, offset, header.weights_offset);
+        output.write(reinterpret_cast<const char*>(routes->weights), static_cast<std::streamsize>(cell_count * sizeof(double)));
+        offset += cell_count * sizeof(double);
+
+        WritePadding(output, offset, header.prev_edges_offset);
+        output.write(reinterpret_cast<const char*>(routes->prev_edges), static_cast<std::streamsize>(cell_count * sizeof(uint32_t)));
+    }
+}
+
+} // end namespace NS_TransportCatalogue::Serealization_Worker
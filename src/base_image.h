@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string_view>
+
+namespace NS_TransportCatalogue::Serealization_Worker
+{
+
+// Файл, отображенный в память только для чтения, отображение живет до разрушения объекта
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::filesystem::path& file);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* GetData() const;
+    size_t GetSize() const;
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+}; // end class MappedFile
+
+// Таблица маршрутов всех пар в образе: построчные массивы весов и последних ребер
+struct BaseImageRoutes
+{
+    uint64_t vertex_count = 0;
+    const double* weights = nullptr;
+    const uint32_t* prev_edges = nullptr;
+};
+
+// Образ базы: заголовок с сигнатурой и версией, секция каталога в protobuf без таблицы маршрутов
+// и выровненная таблица маршрутов, которая читается прямо из отображенного файла без копирования
+struct BaseImage
+{
+    std::string_view catalogue;
+    bool has_routes = false;
+    BaseImageRoutes routes;
+};
+
+bool IsBaseImage(const char* data, size_t size);
+BaseImage ReadBaseImage(const char* data, size_t size);
+void WriteBaseImage(std::ostream& output, std::string_view catalogue, const BaseImageRoutes* routes);
+
+} // end namespace NS_TransportCatalogue::Serealization_Worker
@@ -0,0 +1,54 @@
+#include <atomic>
+
+#include "base_snapshot.h"
+#include "serialization.h"
+
+namespace NS_TransportCatalogue::Interfaces
+{
+
+// ======Class BaseSnapshot===========
+
+std::shared_ptr<const BaseSnapshot> BaseSnapshot::Load(std::istream& input)
+{
+    std::shared_ptr<BaseSnapshot> snapshot(new BaseSnapshot());
+    JsonReader& reader = snapshot->reader_;
+    reader.ReadInput(input);
+
+    const auto file = reader.GetFilePath();
+    if (file)
+    {
+        Serealization_Worker::Deserealization d_worker(snapshot->catalogue_);
+        d_worker.RunDeserealization(*file, reader);
+    }
+
+    // маршрутизатор строится до публикации, запросы к снимку его не меняют
+    if (reader.GetRouterSettings().bus_speed != 0)
+    {
+        reader.RunCreateRouter();
+    }
+    return snapshot;
+}
+
+const TransportCatalogue& BaseSnapshot::GetCatalogue() const
+{
+    return catalogue_;
+}
+
+const JsonReader& BaseSnapshot::GetReader() const
+{
+    return reader_;
+}
+
+// ======Class SnapshotHolder===========
+
+std::shared_ptr<const BaseSnapshot> SnapshotHolder::Get() const
+{
+    return std::atomic_load_explicit(&snapshot_, std::memory_order_acquire);
+}
+
+void SnapshotHolder::Publish(std::shared_ptr<const BaseSnapshot> snapshot)
+{
+    std::atomic_store_explicit(&snapshot_, std::move(snapshot), std::memory_order_release);
+}
+
+} // end namespace NS_TransportCatalogue::Interfaces
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+
+#include "json_reader.h"
+
+namespace NS_TransportCatalogue::Interfaces
+{
+
+// Неизменяемый снимок базы: каталог и JsonReader с графом, маршрутизатором и настройками рендера.
+// После Load объект только читается, поэтому снимок можно отдавать нескольким потокам
+class BaseSnapshot
+{
+public:
+    BaseSnapshot(const BaseSnapshot&) = delete;
+    BaseSnapshot& operator=(const BaseSnapshot&) = delete;
+
+    // читает документ с serialization_settings и/или base_requests, загружает базу и строит маршрутизатор
+    static std::shared_ptr<const BaseSnapshot> Load(std::istream& input);
+
+    const TransportCatalogue& GetCatalogue() const;
+    const JsonReader& GetReader() const;
+
+private:
+    BaseSnapshot() = default;
+
+    TransportCatalogue catalogue_;
+    JsonReader reader_{catalogue_};
+}; // end class BaseSnapshot
+
+// Текущий снимок базы. Чтение и публикация - атомарные операции над shared_ptr, без мьютексов
+// в коде читателей. Читатель держит полученный shared_ptr, пока отвечает, поэтому прежний снимок
+// освобождается вместе с последним читателем, а новый виден только собранным целиком
+class SnapshotHolder
+{
+public:
+    std::shared_ptr<const BaseSnapshot> Get() const;
+    void Publish(std::shared_ptr<const BaseSnapshot> snapshot);
+
+private:
+    std::shared_ptr<const BaseSnapshot> snapshot_;
+}; // end class SnapshotHolder
+
+} // end namespace NS_TransportCatalogue::Interfaces
@@ -0,0 +1,133 @@
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "base_update.h"
+
+namespace NS_TransportCatalogue::Base_Update
+{
+
+namespace
+{
+
+void CheckUnique(std::unordered_set<std::string_view>& names, std::string_view name, std::string_view type)
+{
+    if (!names.insert(name).second)
+    {
+        throw std::invalid_argument("update error: duplicate " + std::string{type} + " - " + std::string{name});
+    }
+}
+
+} // end namespace
+
+BaseUpdater::BaseUpdater(const TransportCatalogue& catalog)
+    : DB_Worker(catalog), previous_(catalog), fields_(DB_Worker::GetSerealizFields()) {}
+
+void BaseUpdater::Apply(const BaseDelta& delta, TransportCatalogue& updated) const
+{
+    std::unordered_set<std::string_view> stop_names;
+    std::unordered_map<std::string_view, const StopUpdate*> stop_updates;
+    for (const auto& update : delta.stops)
+    {
+        CheckUnique(stop_names, update.stop.name, "Stop");
+        stop_updates.emplace(update.stop.name, &update);
+    }
+    std::unordered_set<std::string_view> removed_stops;
+    for (const auto name : delta.removed_stops)
+    {
+        CheckUnique(stop_names, name, "Stop");
+        if (previous_.GetStopPtr(name) == nullptr)
+        {
+            throw std::invalid_argument("Stop - " + std::string{name} + " - not found");
+        }
+        removed_stops.insert(name);
+    }
+
+    std::unordered_set<std::string_view> bus_names;
+    std::unordered_map<std::string_view, const TransportCatalogue::BusInput*> bus_updates;
+    for (const auto& update : delta.buses)
+    {
+        CheckUnique(bus_names, update.name, "Bus");
+        bus_updates.emplace(update.name, &update);
+    }
+    std::unordered_set<std::string_view> removed_buses;
+    for (const auto name : delta.removed_buses)
+    {
+        CheckUnique(bus_names, name, "Bus");
+        if (!previous_.GetBusStats(name))
+        {
+            throw std::invalid_argument("Bus - " + std::string{name} + " - not found");
+        }
+        removed_buses.insert(name);
+    }
+
+    // остановки: прежние на своих местах, затем новые
+    for (const auto& stop : fields_.stops_base_)
+    {
+        if (removed_stops.count(stop.name))
+        {
+            continue;
+        }
+        const auto iter = stop_updates.find(stop.name);
+        updated.AddStop(domain::Stop{stop.name, iter != stop_updates.end() ? iter->second->stop.coordinates : stop.coordinates});
+    }
+    for (const auto& update : delta.stops)
+    {
+        if (previous_.GetStopPtr(update.stop.name) == nullptr)
+        {
+            updated.AddStop(domain::Stop{update.stop.name, update.stop.coordinates});
+        }
+    }
+
+    // расстояния измененных остановок заменяются новыми целиком
+    fields_.length_stop_to_neighbor_.ForEach([&](size_t from_id, size_t to_id, unsigned int length)
+    {
+        const std::string_view from = fields_.stops_base_[from_id].name;
+        const std::string_view to = fields_.stops_base_[to_id].name;
+        if (stop_updates.count(from) || removed_stops.count(from) || removed_stops.count(to))
+        {
+            return;
+        }
+        updated.AddDistance(from, to, length);
+    });
+    for (const auto& update : delta.stops)
+    {
+        for (const auto& [to, length] : update.road_distances)
+        {
+            updated.AddDistance(update.stop.name, to, length);
+        }
+    }
+
+    // маршруты; маршрут через удаленную остановку не найдет ее в новой базе
+    for (const auto& bus : fields_.bus_base_)
+    {
+        if (removed_buses.count(bus.name))
+        {
+            continue;
+        }
+        const auto iter = bus_updates.find(bus.name);
+        if (iter != bus_updates.end())
+        {
+            updated.AddBus(TransportCatalogue::BusInput{*iter->second});
+            continue;
+        }
+
+        std::vector<std::string_view> stops;
+        stops.reserve(bus.stops.size());
+        for (const domain::Stop* stop : bus.stops)
+        {
+            stops.push_back(stop->name);
+        }
+        updated.AddBus(TransportCatalogue::BusInput{std::string{bus.name}, std::move(stops), bus.root_type});
+    }
+    for (const auto& update : delta.buses)
+    {
+        if (!previous_.GetBusStats(update.name))
+        {
+            updated.AddBus(TransportCatalogue::BusInput{update});
+        }
+    }
+}
+
+} // end namespace NS_TransportCatalogue::Base_Update
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "transport_catalogue.h"
+
+namespace NS_TransportCatalogue::Base_Update
+{
+
+// Новая или измененная остановка: координаты и расстояния до соседей заменяют прежние целиком
+struct StopUpdate
+{
+    domain::Stop stop;
+    std::vector<std::pair<std::string_view, unsigned int>> road_distances;
+};
+
+// Изменения базы из update_requests, имена указывают во входной документ
+struct BaseDelta
+{
+    std::vector<StopUpdate> stops;
+    std::vector<TransportCatalogue::BusInput> buses;
+    std::vector<std::string_view> removed_stops;
+    std::vector<std::string_view> removed_buses;
+};
+
+// Собирает новую версию базы из прежней и изменений. Остановки и маршруты сохраняют свой порядок,
+// новые добавляются в конец, поэтому неизмененная часть графа маршрутов совпадает с прежней
+class BaseUpdater final : public DB_Worker
+{
+public:
+    BaseUpdater(const TransportCatalogue& catalog);
+
+    void Apply(const BaseDelta& delta, TransportCatalogue& updated) const;
+
+private:
+    const TransportCatalogue& previous_;
+    DB_Worker::Serealiz_TC_Fields fields_;
+}; // end class BaseUpdater
+
+} // end namespace NS_TransportCatalogue::Base_Update
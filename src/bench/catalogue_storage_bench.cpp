@@ -0,0 +1,196 @@
+// Хранилище остановок и маршрутов на синтетической сети: по умолчанию 100000 остановок
+// и 20000 маршрутов по 25 остановок со случайными остановками.
+// Хранилища ChunkedStorage (как в TransportCatalogue), std::list и std::deque сравниваются
+// на одинаковой работе: загрузка - добавление элементов с индексом по имени и списками
+// остановок маршрутов, как в AddStop/AddBus, обход - проход по маршрутам и координатам их
+// остановок, как при построении графа и рендере. Отдельно замеряется загрузка TransportCatalogue.
+//
+// catalogue_storage_bench [stop_count] [bus_count] [bus_length]
+
+#include "chunked_storage.h"
+#include "transport_catalogue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int ITERATION_PASSES = 20;
+// у каждого хранилища берется лучший из запусков, чтобы порядок замеров не влиял на результат
+constexpr int RUN_COUNT = 3;
+
+struct Network
+{
+    std::vector<std::string> stop_names;
+    std::vector<geo::Coordinates> coordinates;
+    std::vector<std::string> bus_names;
+    std::vector<std::vector<size_t>> bus_stops;
+};
+
+Network GenerateNetwork(size_t stop_count, size_t bus_count, size_t bus_length)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> lat(55.5, 55.9);
+    std::uniform_real_distribution<double> lng(37.3, 37.9);
+    std::uniform_int_distribution<size_t> stop_id(0, stop_count - 1);
+
+    Network out;
+    for (size_t i = 0; i < stop_count; ++i)
+    {
+        out.stop_names.push_back("Stop " + std::to_string(i));
+        out.coordinates.push_back({lat(random), lng(random)});
+    }
+    for (size_t i = 0; i < bus_count; ++i)
+    {
+        out.bus_names.push_back("Bus " + std::to_string(i));
+        auto& stops = out.bus_stops.emplace_back();
+        for (size_t k = 0; k < bus_length; ++k)
+        {
+            stops.push_back(stop_id(random));
+        }
+    }
+    return out;
+}
+
+double GetSeconds(Clock::time_point begin)
+{
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+struct Result
+{
+    double load = 0;
+    double iteration = 0;
+    double destruction = 0;
+    double checksum = 0;
+};
+
+template <typename StopStorage, typename BusStorage>
+Result MeasureOnce(const Network& network)
+{
+    Result out;
+    auto begin = Clock::now();
+    {
+        auto stops = std::make_unique<StopStorage>();
+        auto buses = std::make_unique<BusStorage>();
+        std::unordered_map<std::string_view, domain::Stop*> stops_index;
+        std::unordered_map<std::string_view, domain::Bus*> bus_index;
+
+        for (size_t i = 0; i < network.stop_names.size(); ++i)
+        {
+            stops->push_back(domain::Stop{network.stop_names[i], network.coordinates[i]});
+            domain::Stop& stop = stops->back();
+            stop.id = i;
+            stops_index[stop.name] = &stop;
+        }
+        for (size_t i = 0; i < network.bus_names.size(); ++i)
+        {
+            buses->push_back(domain::Bus{});
+            domain::Bus& bus = buses->back();
+            bus.name = network.bus_names[i];
+            bus.id = i;
+            bus.stops.reserve(network.bus_stops[i].size());
+            for (const size_t stop : network.bus_stops[i])
+            {
+                bus.stops.push_back(stops_index.at(network.stop_names[stop]));
+            }
+            bus.hop_lengths.assign(bus.stops.size() - 1, 0);
+            bus_index[bus.name] = &bus;
+        }
+        out.load = GetSeconds(begin);
+
+        begin = Clock::now();
+        for (int pass = 0; pass < ITERATION_PASSES; ++pass)
+        {
+            for (const domain::Stop& stop : *stops)
+            {
+                out.checksum += stop.coordinates.lat;
+            }
+            for (const domain::Bus& bus : *buses)
+            {
+                for (const domain::Stop* stop : bus.stops)
+                {
+                    out.checksum += stop->coordinates.lng + static_cast<double>(stop->id);
+                }
+            }
+        }
+        out.iteration = GetSeconds(begin) / ITERATION_PASSES;
+
+        begin = Clock::now();
+    }
+    out.destruction = GetSeconds(begin);
+    return out;
+}
+
+template <typename StopStorage, typename BusStorage>
+Result Measure(const Network& network)
+{
+    Result out = MeasureOnce<StopStorage, BusStorage>(network);
+    for (int run = 1; run < RUN_COUNT; ++run)
+    {
+        const Result result = MeasureOnce<StopStorage, BusStorage>(network);
+        out.load = std::min(out.load, result.load);
+        out.iteration = std::min(out.iteration, result.iteration);
+        out.destruction = std::min(out.destruction, result.destruction);
+    }
+    return out;
+}
+
+void Print(const char* name, const Result& result)
+{
+    std::cout << name << "\tload " << result.load * 1000 << " ms\titeration " << result.iteration * 1000
+              << " ms\tdestruction " << result.destruction * 1000 << " ms\t(checksum " << result.checksum << ")\n";
+}
+
+void MeasureCatalogue(const Network& network)
+{
+    const auto begin = Clock::now();
+    NS_TransportCatalogue::TransportCatalogue catalog;
+    for (size_t i = 0; i < network.stop_names.size(); ++i)
+    {
+        catalog.AddStop(domain::Stop{network.stop_names[i], network.coordinates[i]});
+    }
+    for (size_t i = 0; i < network.bus_names.size(); ++i)
+    {
+        std::vector<std::string_view> stops;
+        for (const size_t stop : network.bus_stops[i])
+        {
+            stops.push_back(network.stop_names[stop]);
+        }
+        for (size_t k = 1; k < stops.size(); ++k)
+        {
+            catalog.AddDistance(stops[k - 1], stops[k], 1000);
+        }
+        catalog.AddBus({network.bus_names[i], std::move(stops), domain::BussRootType::CYCLE});
+    }
+    std::cout << "TransportCatalogue\tload " << GetSeconds(begin) * 1000 << " ms\n";
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t stop_count = argc > 1 ? std::stoul(argv[1]) : 100000;
+    const size_t bus_count = argc > 2 ? std::stoul(argv[2]) : 20000;
+    const size_t bus_length = argc > 3 ? std::stoul(argv[3]) : 25;
+
+    const Network network = GenerateNetwork(stop_count, bus_count, bus_length);
+    std::cout << stop_count << " stops, " << bus_count << " buses x " << bus_length << " stops\n";
+
+    Print("ChunkedStorage", Measure<chunked_storage::ChunkedStorage<domain::Stop>, chunked_storage::ChunkedStorage<domain::Bus>>(network));
+    Print("std::list", Measure<std::list<domain::Stop>, std::list<domain::Bus>>(network));
+    Print("std::deque", Measure<std::deque<domain::Stop>, std::deque<domain::Bus>>(network));
+    MeasureCatalogue(network);
+
+    return 0;
+}
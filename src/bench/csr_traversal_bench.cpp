@@ -0,0 +1,238 @@
+// Обход исходящих ребер в CSR против прежнего хранения графа: вектор номеров ребер на каждую
+// вершину и обращение к ребру через GetEdge. Случайный граф: vertex_count вершин, по out_degree
+// исходящих ребер случайного веса, ребра добавляются в случайном порядке вершин, как в каталоге
+// ребра разных маршрутов перемешаны. На одном графе замеряются:
+// - проход по всем исходящим ребрам всех вершин;
+// - поиск Дейкстры между случайными парами вершин с одной и той же кучей SearchScratch, различается
+//   только чтение ребер;
+// - graph::DijkstraRouter::BuildRoute на тех же парах.
+// Берется лучший из запусков. Веса маршрутов во всех трех поисках должны совпасть,
+// код возврата не 0, если нашлись расхождения.
+//
+// csr_traversal_bench [vertex_count] [out_degree] [query_count] [seed]
+
+#include "dijkstra_router.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+using Weight = double;
+using Graph = graph::DirectedWeightedGraph<Weight>;
+using ScratchData = graph::SearchScratch<Weight>;
+using IncidenceLists = std::vector<std::vector<graph::EdgeId>>;
+
+constexpr int RUN_COUNT = 3;
+
+double GetSeconds(Clock::time_point begin)
+{
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+Graph GenerateGraph(size_t vertex_count, size_t out_degree, std::mt19937& random)
+{
+    std::uniform_int_distribution<graph::VertexId> vertex(0, vertex_count - 1);
+    std::uniform_int_distribution<int> weight(0, 999);
+
+    std::vector<graph::Edge<Weight>> edges;
+    edges.reserve(vertex_count * out_degree);
+    for (graph::VertexId from = 0; from < vertex_count; ++from)
+    {
+        for (size_t i = 0; i < out_degree; ++i)
+        {
+            edges.push_back({from, vertex(random), weight(random) / 10.0});
+        }
+    }
+    std::shuffle(edges.begin(), edges.end(), random);
+
+    Graph out(vertex_count);
+    for (const auto& edge : edges)
+    {
+        out.AddEdge(edge);
+    }
+    out.Freeze();
+    return out;
+}
+
+// хранение графа до CSR: у каждой вершины свой вектор номеров исходящих ребер
+IncidenceLists BuildIncidenceLists(const Graph& graph)
+{
+    IncidenceLists out(graph.GetVertexCount());
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id)
+    {
+        out[graph.GetEdge(edge_id).from].push_back(edge_id);
+    }
+    return out;
+}
+
+double SweepIncidenceLists(const Graph& graph, const IncidenceLists& incidence_lists)
+{
+    double out = 0;
+    for (graph::VertexId vertex = 0; vertex < incidence_lists.size(); ++vertex)
+    {
+        for (const graph::EdgeId edge_id : incidence_lists[vertex])
+        {
+            const auto& edge = graph.GetEdge(edge_id);
+            out += edge.weight + static_cast<double>(edge.to);
+        }
+    }
+    return out;
+}
+
+double SweepCsr(const Graph& graph)
+{
+    double out = 0;
+    for (graph::VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex)
+    {
+        const auto outgoing = graph.GetOutgoingEdges(vertex);
+        for (size_t i = 0; i < outgoing.count; ++i)
+        {
+            out += outgoing.weights[i] + static_cast<double>(outgoing.targets[i]);
+        }
+    }
+    return out;
+}
+
+// Дейкстра от from до извлечения to из кучи, for_each_edge(vertex, relax) перебирает исходящие ребра
+template <typename ForEachEdge>
+std::optional<Weight> FindWeight(ScratchData& scratch, size_t vertex_count, graph::VertexId from, graph::VertexId to,
+                                 ForEachEdge&& for_each_edge)
+{
+    scratch.Prepare(vertex_count);
+    scratch.Relax(from, 0, ScratchData::NO_EDGE);
+    while (!scratch.heap.empty())
+    {
+        const auto item = scratch.Pop();
+        if (scratch.IsStale(item))
+        {
+            continue;
+        }
+        if (item.vertex == to)
+        {
+            return item.weight;
+        }
+        for_each_edge(item.vertex, [&scratch, &item](graph::VertexId target, Weight weight, graph::EdgeId edge_id) {
+            scratch.Relax(target, item.weight + weight, edge_id);
+        });
+    }
+    return std::nullopt;
+}
+
+using Queries = std::vector<std::pair<graph::VertexId, graph::VertexId>>;
+using Answers = std::vector<std::optional<Weight>>;
+
+template <typename FindFunction>
+std::pair<double, Answers> MeasureQueries(const Queries& queries, FindFunction&& find)
+{
+    double best = 0;
+    Answers answers;
+    for (int run = 0; run < RUN_COUNT; ++run)
+    {
+        answers.clear();
+        const auto begin = Clock::now();
+        for (const auto& [from, to] : queries)
+        {
+            answers.push_back(find(from, to));
+        }
+        const double seconds = GetSeconds(begin);
+        best = run == 0 ? seconds : std::min(best, seconds);
+    }
+    return {best, std::move(answers)};
+}
+
+template <typename SweepFunction>
+double MeasureSweep(SweepFunction&& sweep)
+{
+    double best = 0;
+    double checksum = 0;
+    for (int run = 0; run < RUN_COUNT; ++run)
+    {
+        const auto begin = Clock::now();
+        checksum += sweep();
+        const double seconds = GetSeconds(begin);
+        best = run == 0 ? seconds : std::min(best, seconds);
+    }
+    if (checksum == 0)
+    {
+        std::cout << "(graph without edges)\n";
+    }
+    return best;
+}
+
+size_t CountMismatches(const Answers& expected, const Answers& actual)
+{
+    size_t out = 0;
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        out += expected[i] != actual[i];
+    }
+    return out;
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t vertex_count = argc > 1 ? std::stoul(argv[1]) : 500000;
+    const size_t out_degree = argc > 2 ? std::stoul(argv[2]) : 4;
+    const size_t query_count = argc > 3 ? std::stoul(argv[3]) : 50;
+    std::mt19937 random(argc > 4 ? std::stoul(argv[4]) : 1);
+
+    const Graph graph = GenerateGraph(vertex_count, out_degree, random);
+    const IncidenceLists incidence_lists = BuildIncidenceLists(graph);
+    std::cout << vertex_count << " vertices, " << graph.GetEdgeCount() << " edges, " << query_count << " queries\n";
+
+    std::cout << "sweep\tincidence lists " << MeasureSweep([&] {
+        return SweepIncidenceLists(graph, incidence_lists);
+    }) * 1000 << " ms\tCSR " << MeasureSweep([&] {
+        return SweepCsr(graph);
+    }) * 1000 << " ms\n";
+
+    std::uniform_int_distribution<graph::VertexId> vertex(0, vertex_count - 1);
+    Queries queries;
+    for (size_t i = 0; i < query_count; ++i)
+    {
+        queries.emplace_back(vertex(random), vertex(random));
+    }
+
+    ScratchData scratch;
+    const auto [list_time, list_answers] = MeasureQueries(queries, [&](graph::VertexId from, graph::VertexId to) {
+        return FindWeight(scratch, vertex_count, from, to, [&](graph::VertexId vertex, auto&& relax) {
+            for (const graph::EdgeId edge_id : incidence_lists[vertex])
+            {
+                const auto& edge = graph.GetEdge(edge_id);
+                relax(edge.to, edge.weight, edge_id);
+            }
+        });
+    });
+    const auto [csr_time, csr_answers] = MeasureQueries(queries, [&](graph::VertexId from, graph::VertexId to) {
+        return FindWeight(scratch, vertex_count, from, to, [&](graph::VertexId vertex, auto&& relax) {
+            const auto outgoing = graph.GetOutgoingEdges(vertex);
+            for (size_t i = 0; i < outgoing.count; ++i)
+            {
+                relax(outgoing.targets[i], outgoing.weights[i], outgoing.edge_ids[i]);
+            }
+        });
+    });
+    const graph::DijkstraRouter<Weight> router(graph);
+    const auto [router_time, router_answers] = MeasureQueries(queries, [&](graph::VertexId from, graph::VertexId to) {
+        const auto route = router.BuildRoute(from, to);
+        return route ? std::optional<Weight>(route->weight) : std::nullopt;
+    });
+
+    const size_t mismatches = CountMismatches(list_answers, csr_answers) + CountMismatches(list_answers, router_answers);
+    const double per_query = 1000.0 / std::max<size_t>(query_count, 1);
+    std::cout << "dijkstra\tincidence lists " << list_time * per_query << " ms/query\tCSR " << csr_time * per_query
+              << " ms/query\tDijkstraRouter " << router_time * per_query << " ms/query\tmismatched weights " << mismatches << "\n";
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,262 @@
+// Разбор JSON: время Load, число выделений памяти через operator new за разбор, время обхода
+// документа теми же обращениями по ключам, что делает JsonReader, и время разрушения документа.
+// Без аргументов разбираются два сгенерированных входа: make_base (остановки с длинными именами
+// и road_distances, маршруты) и stat_requests (множество мелких словарей запросов). Каждый
+// разбирается с Allocation::HEAP и Allocation::ARENA, берется лучший из запусков.
+// С аргументом разбирается указанный файл, обход тогда не замеряется.
+//
+// json_parse_bench [input.json]
+
+#include "json.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// выделения памяти через operator new, программа однопоточная
+size_t allocation_count = 0;
+
+} // end namespace
+
+void* operator new(size_t size)
+{
+    ++allocation_count;
+    if (void* out = std::malloc(size == 0 ? 1 : size))
+    {
+        return out;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+// через выравнивающий operator new выделяет память std::pmr::new_delete_resource
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    ++allocation_count;
+    const size_t align = static_cast<size_t>(alignment);
+    if (void* out = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align))
+    {
+        return out;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int RUN_COUNT = 3;
+
+double GetSeconds(Clock::time_point begin)
+{
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+std::string GenerateName(std::mt19937& random, size_t index)
+{
+    static const char LETTERS[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ";
+    std::string out;
+    for (int length = 16 + random() % 16; length > 0; --length)
+    {
+        out += LETTERS[random() % (sizeof(LETTERS) - 1)];
+    }
+    return out + std::to_string(index);
+}
+
+std::string GenerateMakeBase(size_t stop_count, size_t bus_count)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> lat(55.5, 55.9);
+    std::uniform_real_distribution<double> lng(37.3, 37.9);
+
+    std::vector<std::string> names;
+    for (size_t i = 0; i < stop_count; ++i)
+    {
+        names.push_back(GenerateName(random, i));
+    }
+
+    std::ostringstream out;
+    out << "{\"routing_settings\": {\"bus_wait_time\": 6, \"bus_velocity\": 40}, \"base_requests\": [\n";
+    for (size_t i = 0; i < stop_count; ++i)
+    {
+        out << "{\"type\": \"Stop\", \"name\": \"" << names[i] << "\", \"latitude\": " << lat(random)
+            << ", \"longitude\": " << lng(random) << ", \"road_distances\": {";
+        for (size_t k = 0; k < 10; ++k)
+        {
+            out << (k == 0 ? "" : ", ") << "\"" << names[(i + 1 + k * 7) % stop_count] << "\": " << 100 + random() % 5000;
+        }
+        out << "}},\n";
+    }
+    for (size_t i = 0; i < bus_count; ++i)
+    {
+        out << "{\"type\": \"Bus\", \"name\": \"Bus " << i << "\", \"is_roundtrip\": false, \"stops\": [";
+        for (size_t k = 0; k < 40; ++k)
+        {
+            out << (k == 0 ? "" : ", ") << "\"" << names[random() % stop_count] << "\"";
+        }
+        out << "]}" << (i + 1 == bus_count ? "\n" : ",\n");
+    }
+    out << "]}\n";
+    return out.str();
+}
+
+std::string GenerateStatRequests(size_t request_count)
+{
+    std::ostringstream out;
+    out << "{\"stat_requests\": [\n";
+    for (size_t i = 0; i < request_count; ++i)
+    {
+        out << "{\"id\": " << i << ", \"type\": \"Bus\", \"name\": \"Bus " << i % 1000 << "\"}"
+            << (i + 1 == request_count ? "\n" : ",\n");
+    }
+    out << "]}\n";
+    return out.str();
+}
+
+// обращения к документу, как при загрузке base_requests и ответе на stat_requests в JsonReader
+double VisitRequests(const json::Document& document)
+{
+    double out = 0;
+    const json::Dict& root = document.GetRoot().AsDict();
+    if (const auto iter = root.find("base_requests"); iter != root.end())
+    {
+        for (const json::Node& request : iter->second.AsArray())
+        {
+            const json::Dict& value = request.AsDict();
+            out += static_cast<double>(value.at("name").AsString().size());
+            if (value.at("type").AsString() == "Stop")
+            {
+                out += value.at("latitude").AsDouble() + value.at("longitude").AsDouble();
+                for (const auto& [key, length] : value.at("road_distances").AsDict())
+                {
+                    out += static_cast<double>(key.size() + length.AsInt());
+                }
+            }
+            else
+            {
+                out += value.at("is_roundtrip").AsBool();
+                out += static_cast<double>(value.at("stops").AsArray().size());
+            }
+        }
+    }
+    if (const auto iter = root.find("stat_requests"); iter != root.end())
+    {
+        for (const json::Node& request : iter->second.AsArray())
+        {
+            const json::Dict& value = request.AsDict();
+            out += value.at("id").AsInt() + static_cast<double>(value.at("type").AsString().size() + value.at("name").AsString().size());
+        }
+    }
+    return out;
+}
+
+struct Result
+{
+    double parse = 0;
+    size_t allocations = 0;
+    double visit = 0;
+    double destruction = 0;
+};
+
+Result MeasureOnce(const std::string& text, json::Allocation allocation, bool visit)
+{
+    Result out;
+    std::istringstream input(text);
+    auto begin = Clock::now();
+    const size_t allocations_before = allocation_count;
+    std::optional<json::Document> document = json::Load(input, allocation);
+    out.allocations = allocation_count - allocations_before;
+    out.parse = GetSeconds(begin);
+
+    if (visit)
+    {
+        begin = Clock::now();
+        const double checksum = VisitRequests(*document);
+        out.visit = GetSeconds(begin);
+        if (checksum == 0)
+        {
+            std::cout << "(empty document)\n";
+        }
+    }
+
+    begin = Clock::now();
+    document.reset();
+    out.destruction = GetSeconds(begin);
+    return out;
+}
+
+void Measure(const char* name, const std::string& text, bool visit)
+{
+    std::cout << name << ": " << text.size() / 1024 << " KiB\n";
+    for (const auto& [allocation, allocation_name] : {std::pair{json::Allocation::HEAP, "HEAP"}, std::pair{json::Allocation::ARENA, "ARENA"}})
+    {
+        Result out = MeasureOnce(text, allocation, visit);
+        for (int run = 1; run < RUN_COUNT; ++run)
+        {
+            const Result result = MeasureOnce(text, allocation, visit);
+            out.parse = std::min(out.parse, result.parse);
+            out.visit = std::min(out.visit, result.visit);
+            out.destruction = std::min(out.destruction, result.destruction);
+        }
+        std::cout << "  " << allocation_name << "\tparse " << out.parse * 1000 << " ms\tallocations " << out.allocations;
+        if (visit)
+        {
+            std::cout << "\tvisit " << out.visit * 1000 << " ms";
+        }
+        std::cout << "\tdestruction " << out.destruction * 1000 << " ms\n";
+    }
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1)
+    {
+        std::ifstream file(argv[1], std::ios::binary);
+        if (!file)
+        {
+            std::cerr << "Can't open " << argv[1] << "\n";
+            return 1;
+        }
+        Measure(argv[1], std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()), false);
+        return 0;
+    }
+
+    Measure("make_base", GenerateMakeBase(60000, 10000), true);
+    Measure("stat_requests", GenerateStatRequests(300000), true);
+    return 0;
+}
@@ -0,0 +1,379 @@
+// Разбор JSON на случайных документах. Текст генерируется со случайными пробельными символами,
+// escape-последовательностями, байтами вне ASCII, числами на границах int, повторами ключей и
+// вложенностью, примерно половина документов затем портится: удаление, вставка байта или обрезка.
+// Для каждого документа проверяется, что Load из потока, из буфера и с ARENA дают одно и то же
+// дерево или одну и ту же ошибку, а разобранный документ после Print читается в то же дерево.
+// Код возврата не 0, если нашлись расхождения.
+//
+// С --print на каждый документ печатается строка с деревом или текстом ошибки: вывод программы,
+// собранной с другой версией json.cpp, можно сравнить с этим через diff (для старых версий без
+// Allocation и Load(std::string_view) проверки согласованности нужно убрать).
+//
+// json_parse_check [document_count] [seed] [--print]
+
+#include "json.h"
+
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+constexpr int MAX_DEPTH = 5;
+constexpr int MAX_CONTAINER_SIZE = 6;
+
+class TextGenerator
+{
+public:
+    explicit TextGenerator(std::mt19937& random)
+        : random_(random)
+    {
+    }
+
+    std::string Generate()
+    {
+        text_.clear();
+        AddSpaces();
+        AddValue(0);
+        AddSpaces();
+        return text_;
+    }
+
+private:
+    std::mt19937& random_;
+    std::string text_;
+
+    int Roll(int count)
+    {
+        return std::uniform_int_distribution<int>(0, count - 1)(random_);
+    }
+
+    void AddSpaces()
+    {
+        static const char SPACES[] = " \t\r\n";
+        for (int count = Roll(4) == 0 ? Roll(3) + 1 : 0; count > 0; --count)
+        {
+            text_ += SPACES[Roll(4)];
+        }
+    }
+
+    void AddValue(int depth)
+    {
+        switch (Roll(depth < MAX_DEPTH ? 8 : 6))
+        {
+        case 0:
+            AddInt();
+            break;
+        case 1:
+            AddDouble();
+            break;
+        case 2:
+        case 3:
+            AddString();
+            break;
+        case 4:
+            text_ += Roll(2) ? "true" : "false";
+            break;
+        case 5:
+            text_ += "null";
+            break;
+        case 6:
+            AddArray(depth);
+            break;
+        default:
+            AddDict(depth);
+            break;
+        }
+    }
+
+    void AddInt()
+    {
+        static const char* const EDGES[] = {"0", "-0", "2147483647", "-2147483648", "2147483648", "-2147483649", "99999999999"};
+        if (Roll(4) == 0)
+        {
+            text_ += EDGES[Roll(7)];
+            return;
+        }
+        text_ += std::to_string(std::uniform_int_distribution<int>(-1000000, 1000000)(random_));
+    }
+
+    void AddDouble()
+    {
+        if (Roll(2))
+        {
+            text_ += '-';
+        }
+        text_ += std::to_string(Roll(1000));
+        if (Roll(3))
+        {
+            text_ += '.';
+            text_ += std::to_string(Roll(100000));
+        }
+        if (Roll(2))
+        {
+            text_ += Roll(2) ? 'e' : 'E';
+            if (Roll(2))
+            {
+                text_ += Roll(2) ? '-' : '+';
+            }
+            text_ += std::to_string(Roll(30));
+        }
+    }
+
+    void AddString()
+    {
+        static const char* const ESCAPES[] = {"\\n", "\\t", "\\r", "\\\"", "\\\\"};
+        text_ += '"';
+        for (int length = Roll(4) == 0 ? Roll(200) : Roll(12); length > 0; --length)
+        {
+            const int kind = Roll(10);
+            if (kind == 0)
+            {
+                text_ += ESCAPES[Roll(5)];
+            }
+            else if (kind == 1)
+            {
+                text_ += static_cast<char>(0x80 + Roll(0x80));
+            }
+            else
+            {
+                text_ += static_cast<char>('a' + Roll(26));
+            }
+        }
+        text_ += '"';
+    }
+
+    void AddArray(int depth)
+    {
+        text_ += '[';
+        AddSpaces();
+        for (int i = 0, size = Roll(MAX_CONTAINER_SIZE); i < size; ++i)
+        {
+            if (i != 0)
+            {
+                text_ += ',';
+                AddSpaces();
+            }
+            AddValue(depth + 1);
+            AddSpaces();
+        }
+        text_ += ']';
+    }
+
+    void AddDict(int depth)
+    {
+        // ключи из короткого набора, чтобы иногда повторялись
+        static const char* const KEYS[] = {"type", "name", "id", "stops", "a", "b", "key with spaces", "A"};
+        text_ += '{';
+        AddSpaces();
+        for (int i = 0, size = Roll(MAX_CONTAINER_SIZE); i < size; ++i)
+        {
+            if (i != 0)
+            {
+                text_ += ',';
+                AddSpaces();
+            }
+            text_ += '"';
+            text_ += KEYS[Roll(8)];
+            text_ += '"';
+            AddSpaces();
+            text_ += ':';
+            AddSpaces();
+            AddValue(depth + 1);
+            AddSpaces();
+        }
+        text_ += '}';
+    }
+}; // end class TextGenerator
+
+void Corrupt(std::string& text, std::mt19937& random)
+{
+    static const char BYTES[] = "{}[]\",:\\ntfru0123456789.eE-+ \x01\xff";
+    const auto position = [&random](size_t size) {
+        return std::uniform_int_distribution<size_t>(0, size)(random);
+    };
+    for (int count = std::uniform_int_distribution<int>(1, 3)(random); count > 0; --count)
+    {
+        switch (random() % 3)
+        {
+        case 0:
+            if (!text.empty())
+            {
+                text.erase(position(text.size() - 1), 1);
+            }
+            break;
+        case 1:
+            text.insert(text.begin() + position(text.size()), BYTES[random() % (sizeof(BYTES) - 1)]);
+            break;
+        default:
+            text.resize(position(text.size()));
+            break;
+        }
+    }
+}
+
+// Однозначная запись дерева: тип каждого значения, числа с полной точностью, байты строк вне ASCII
+// в hex. Print выводит целое значение double без точки, поэтому после Print числа сравниваются
+// только по значению (exact_numbers == false)
+void Dump(const json::Node& node, bool exact_numbers, std::ostream& out)
+{
+    if (node.IsDouble() && !exact_numbers)
+    {
+        // -0.0 + 0.0 == +0.0: минус нуля после Print теряется вместе с точкой
+        out << "n" << std::setprecision(17) << node.AsDouble() + 0.0;
+    }
+    else if (node.IsInt())
+    {
+        out << "i" << node.AsInt();
+    }
+    else if (node.IsPureDouble())
+    {
+        out << "d" << std::setprecision(17) << node.AsDouble();
+    }
+    else if (node.IsBool())
+    {
+        out << (node.AsBool() ? "true" : "false");
+    }
+    else if (node.IsNull())
+    {
+        out << "null";
+    }
+    else if (node.IsString())
+    {
+        out << "s\"";
+        for (const char c : node.AsString())
+        {
+            const auto byte = static_cast<unsigned char>(c);
+            if (byte < 0x20 || byte >= 0x7f || c == '"' || c == '\\')
+            {
+                out << "\\x" << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte) << std::dec;
+            }
+            else
+            {
+                out << c;
+            }
+        }
+        out << "\"";
+    }
+    else if (node.IsArray())
+    {
+        out << "[";
+        for (const json::Node& item : node.AsArray())
+        {
+            Dump(item, exact_numbers, out);
+            out << ",";
+        }
+        out << "]";
+    }
+    else
+    {
+        out << "{";
+        for (const auto& [key, value] : node.AsDict())
+        {
+            out << key << ":";
+            Dump(value, exact_numbers, out);
+            out << ",";
+        }
+        out << "}";
+    }
+}
+
+// дерево документа или текст ошибки разбора
+template <typename LoadFunction>
+std::string LoadAndDump(LoadFunction&& load, bool exact_numbers = true)
+{
+    std::ostringstream out;
+    try
+    {
+        const json::Document document = load();
+        Dump(document.GetRoot(), exact_numbers, out);
+    }
+    catch (const json::ParsingError& error)
+    {
+        return std::string("error: ") + error.what();
+    }
+    return out.str();
+}
+
+// расхождение разных способов разбора text, если есть
+std::optional<std::string> CheckConsistency(const std::string& text, const std::string& expected)
+{
+    const std::string from_buffer = LoadAndDump([&text] {
+        return json::Load(std::string_view(text));
+    });
+    if (from_buffer != expected)
+    {
+        return "Load(std::string_view): " + from_buffer;
+    }
+    const std::string from_arena = LoadAndDump([&text] {
+        return json::Load(std::string_view(text), json::Allocation::ARENA);
+    });
+    if (from_arena != expected)
+    {
+        return "Load(ARENA): " + from_arena;
+    }
+    if (expected.rfind("error: ", 0) == 0)
+    {
+        return std::nullopt;
+    }
+
+    std::ostringstream printed;
+    printed << std::setprecision(17);
+    json::Print(json::Load(std::string_view(text)), printed);
+    const auto load_text = [&text] {
+        return json::Load(std::string_view(text));
+    };
+    const auto load_printed = [&printed] {
+        return json::Load(std::string_view(printed.str()));
+    };
+    const std::string reloaded = LoadAndDump(load_printed, false);
+    if (reloaded != LoadAndDump(load_text, false))
+    {
+        return "after Print: " + reloaded;
+    }
+    return std::nullopt;
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t document_count = argc > 1 ? std::stoul(argv[1]) : 3000;
+    std::mt19937 random(argc > 2 ? std::stoul(argv[2]) : 1);
+    const bool print = argc > 3 && std::string(argv[3]) == "--print";
+
+    TextGenerator generator(random);
+    size_t rejected = 0;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < document_count; ++i)
+    {
+        std::string text = generator.Generate();
+        if (random() % 2)
+        {
+            Corrupt(text, random);
+        }
+
+        const std::string expected = LoadAndDump([&text] {
+            std::istringstream input(text);
+            return json::Load(input);
+        });
+        rejected += expected.rfind("error: ", 0) == 0;
+        if (print)
+        {
+            std::cout << i << " " << expected << "\n";
+        }
+
+        if (const auto mismatch = CheckConsistency(text, expected))
+        {
+            ++mismatches;
+            std::cerr << "document " << i << ": " << text << "\n  Load(std::istream&): " << expected << "\n  " << *mismatch << "\n";
+        }
+    }
+
+    std::cerr << document_count << " documents, " << rejected << " rejected, " << mismatches << " mismatches\n";
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+// RAPTOR против маршрутизаторов по графу на одной синтетической сети: stop_count остановок,
+// bus_count маршрутов по bus_length случайных остановок, половина кольцевые, половина в обе
+// стороны, длины перегонов случайные. Замеряются подготовка (RaptorRouter, GraphBuilder,
+// таблица всех пар graph::Router, graph::DijkstraRouter) и ответы на query_count маршрутов между
+// случайными остановками, для ответов берется лучший из запусков.
+// Достижимость и total_time всех трех маршрутизаторов должны совпасть,
+// код возврата не 0, если нашлись расхождения.
+//
+// raptor_bench [stop_count] [bus_count] [bus_length] [query_count] [seed]
+
+#include "raptor_router.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using namespace NS_TransportCatalogue;
+using namespace NS_TransportCatalogue::TransportCatalogue_Router;
+
+using Clock = std::chrono::steady_clock;
+using RouterWeight = GraphBuilder::RouterWeight;
+using Graph = graph::DirectedWeightedGraph<RouterWeight>;
+
+constexpr int RUN_COUNT = 3;
+// total_time считается разными суммами перегонов
+constexpr double TIME_TOLERANCE = 1e-6;
+
+double GetSeconds(Clock::time_point begin)
+{
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+void FillCatalogue(TransportCatalogue& catalog, std::vector<std::string>& stop_names, std::vector<std::string>& bus_names,
+                   size_t bus_length, std::mt19937& random)
+{
+    std::uniform_real_distribution<double> lat(55.5, 55.9);
+    std::uniform_real_distribution<double> lng(37.3, 37.9);
+    std::uniform_int_distribution<size_t> stop_id(0, stop_names.size() - 1);
+    std::uniform_int_distribution<unsigned int> length(300, 3000);
+
+    for (size_t i = 0; i < stop_names.size(); ++i)
+    {
+        stop_names[i] = "Stop " + std::to_string(i);
+        catalog.AddStop(domain::Stop{stop_names[i], {lat(random), lng(random)}});
+    }
+
+    std::vector<std::vector<std::string_view>> bus_stops(bus_names.size());
+    for (size_t i = 0; i < bus_names.size(); ++i)
+    {
+        bus_names[i] = "Bus " + std::to_string(i);
+        auto& stops = bus_stops[i];
+        for (size_t k = 0; k < bus_length; ++k)
+        {
+            stops.push_back(stop_names[stop_id(random)]);
+        }
+        // кольцевой маршрут заканчивается на первой остановке
+        if (i % 2 == 0)
+        {
+            stops.push_back(stops.front());
+        }
+        for (size_t k = 1; k < stops.size(); ++k)
+        {
+            catalog.AddDistance(stops[k - 1], stops[k], length(random));
+        }
+    }
+    // расстояния добавляются до маршрутов, как при загрузке base_requests
+    for (size_t i = 0; i < bus_names.size(); ++i)
+    {
+        catalog.AddBus({bus_names[i], std::move(bus_stops[i]), i % 2 == 0 ? domain::BussRootType::CYCLE : domain::BussRootType::FORWARD});
+    }
+}
+
+using Queries = std::vector<std::pair<const domain::Stop*, const domain::Stop*>>;
+using Answers = std::vector<std::optional<double>>;
+
+template <typename FindFunction>
+std::pair<double, Answers> MeasureQueries(const Queries& queries, FindFunction&& find)
+{
+    double best = 0;
+    Answers answers;
+    for (int run = 0; run < RUN_COUNT; ++run)
+    {
+        answers.clear();
+        const auto begin = Clock::now();
+        for (const auto& [from, to] : queries)
+        {
+            answers.push_back(find(from, to));
+        }
+        const double seconds = GetSeconds(begin);
+        best = run == 0 ? seconds : std::min(best, seconds);
+    }
+    return {best, std::move(answers)};
+}
+
+size_t CountMismatches(const Answers& expected, const Answers& actual)
+{
+    size_t out = 0;
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        if (expected[i].has_value() != actual[i].has_value())
+        {
+            ++out;
+        }
+        else if (expected[i] && std::fabs(*expected[i] - *actual[i]) > TIME_TOLERANCE * std::max(1.0, *expected[i]))
+        {
+            ++out;
+        }
+    }
+    return out;
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t stop_count = argc > 1 ? std::stoul(argv[1]) : 800;
+    const size_t bus_count = argc > 2 ? std::stoul(argv[2]) : 150;
+    const size_t bus_length = argc > 3 ? std::stoul(argv[3]) : 20;
+    const size_t query_count = argc > 4 ? std::stoul(argv[4]) : 3000;
+    std::mt19937 random(argc > 5 ? std::stoul(argv[5]) : 1);
+
+    TransportCatalogue catalog;
+    std::vector<std::string> stop_names(stop_count);
+    std::vector<std::string> bus_names(bus_count);
+    FillCatalogue(catalog, stop_names, bus_names, bus_length, random);
+
+    const RouterSettings settings{40, 6};
+
+    auto begin = Clock::now();
+    const RaptorRouter raptor_router(catalog, settings);
+    const double raptor_build_time = GetSeconds(begin);
+
+    begin = Clock::now();
+    GraphBuilder graph_builder(catalog, settings);
+    const Graph& graph = graph_builder.GetGraphRef();
+    const double graph_build_time = GetSeconds(begin);
+
+    begin = Clock::now();
+    const graph::Router<RouterWeight> all_pairs_router(graph);
+    const double all_pairs_build_time = GetSeconds(begin);
+
+    begin = Clock::now();
+    const graph::DijkstraRouter<RouterWeight> dijkstra_router(graph);
+    const double dijkstra_build_time = GetSeconds(begin);
+
+    std::cout << stop_count << " stops, " << bus_count << " buses, " << graph.GetVertexCount() << " vertices, "
+              << graph.GetEdgeCount() << " edges, " << query_count << " queries\n";
+
+    std::uniform_int_distribution<size_t> stop_id(0, stop_count - 1);
+    Queries queries;
+    for (size_t i = 0; i < query_count; ++i)
+    {
+        queries.emplace_back(catalog.GetStopPtr(stop_names[stop_id(random)]), catalog.GetStopPtr(stop_names[stop_id(random)]));
+    }
+
+    const auto [raptor_time, raptor_answers] = MeasureQueries(queries, [&](const domain::Stop* from, const domain::Stop* to) {
+        const auto route = raptor_router.BuildRoute(from, to);
+        return route ? std::optional<double>(route->total_time) : std::nullopt;
+    });
+    // вершина остановки в графе, как при ответе JsonReader
+    const auto find_in_graph = [&](const graph::RouterBase<RouterWeight>& router) {
+        return [&](const domain::Stop* from, const domain::Stop* to) {
+            const auto route = router.BuildRoute(*graph_builder.GetBusID(from->name), *graph_builder.GetBusID(to->name));
+            return route ? std::optional<double>(route->weight.weight) : std::nullopt;
+        };
+    };
+    const auto [all_pairs_time, all_pairs_answers] = MeasureQueries(queries, find_in_graph(all_pairs_router));
+    const auto [dijkstra_time, dijkstra_answers] = MeasureQueries(queries, find_in_graph(dijkstra_router));
+
+    const size_t mismatches = CountMismatches(all_pairs_answers, raptor_answers) + CountMismatches(all_pairs_answers, dijkstra_answers);
+    const double per_query = 1e6 / std::max<size_t>(query_count, 1);
+    std::cout << "raptor\tbuild " << raptor_build_time * 1000 << " ms\tquery " << raptor_time * per_query << " us\n"
+              << "all_pairs\tbuild " << (graph_build_time + all_pairs_build_time) * 1000 << " ms (graph "
+              << graph_build_time * 1000 << " ms)\tquery " << all_pairs_time * per_query << " us\n"
+              << "dijkstra\tbuild " << (graph_build_time + dijkstra_build_time) * 1000 << " ms\tquery "
+              << dijkstra_time * per_query << " us\n"
+              << "mismatched total times " << mismatches << "\n";
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+// Пересчет таблицы всех пар после изменения весов ребер на случайном графе: vertex_count вершин,
+// по out_degree исходящих ребер случайного веса. За шаг меняется вес от 1 до 3 случайных ребер,
+// таблица обновляется Router::UpdateEdgeWeights и сравнивается с таблицей нового Router по тому же
+// графу: во всех ячейках совпадают достижимость и вес, последнее ребро маршрута ведет в нужную
+// вершину и дает тот же вес. Так проверяется, что строки, которые не пересчитывались, верны.
+// Время обновления печатается рядом со временем построения таблицы заново.
+// Код возврата не 0, если нашлись расхождения.
+//
+// router_update_check [vertex_count] [out_degree] [step_count] [seed]
+
+#include "router.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+using Graph = graph::DirectedWeightedGraph<double>;
+using Router = graph::Router<double>;
+using RoutesInternalData = Router::RoutesInternalData;
+
+constexpr double WEIGHT_TOLERANCE = 1e-6;
+
+double GetSeconds(Clock::time_point begin)
+{
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+Graph GenerateGraph(size_t vertex_count, size_t out_degree, std::mt19937& random)
+{
+    std::uniform_int_distribution<graph::VertexId> vertex(0, vertex_count - 1);
+    std::uniform_int_distribution<int> weight(0, 999);
+
+    Graph out(vertex_count);
+    for (graph::VertexId from = 0; from < vertex_count; ++from)
+    {
+        for (size_t i = 0; i < out_degree; ++i)
+        {
+            out.AddEdge({from, vertex(random), weight(random) / 10.0});
+        }
+    }
+    out.Freeze();
+    return out;
+}
+
+// меняет вес нескольких ребер: половина становится дешевле, половина дороже
+std::vector<graph::EdgeId> ChangeWeights(Graph& graph, size_t change_count, std::mt19937& random)
+{
+    std::uniform_int_distribution<graph::EdgeId> edge(0, graph.GetEdgeCount() - 1);
+
+    std::vector<graph::EdgeId> out;
+    for (size_t i = 0; i < change_count; ++i)
+    {
+        const graph::EdgeId edge_id = edge(random);
+        const double weight = graph.GetEdge(edge_id).weight;
+        graph.SetEdgeWeight(edge_id, random() % 2 ? weight * 0.3 : weight * 3 + 5);
+        out.push_back(edge_id);
+    }
+    return out;
+}
+
+// число ячеек updated, расходящихся с expected
+size_t CountMismatches(const Graph& graph, const Router& updated, const Router& expected)
+{
+    const Router::RoutesView actual = updated.GetData().routes;
+    const Router::RoutesView reference = expected.GetData().routes;
+    const size_t vertex_count = graph.GetVertexCount();
+
+    size_t out = 0;
+    for (graph::VertexId from = 0; from < vertex_count; ++from)
+    {
+        const size_t row = from * vertex_count;
+        for (graph::VertexId to = 0; to < vertex_count; ++to)
+        {
+            const uint32_t prev_edge = actual.prev_edges[row + to];
+            const bool is_reachable = prev_edge != RoutesInternalData::NO_ROUTE;
+            if (is_reachable != (reference.prev_edges[row + to] != RoutesInternalData::NO_ROUTE))
+            {
+                ++out;
+                continue;
+            }
+            if (!is_reachable)
+            {
+                continue;
+            }
+            const double weight = actual.weights[row + to];
+            if (std::fabs(weight - reference.weights[row + to]) > WEIGHT_TOLERANCE)
+            {
+                ++out;
+                continue;
+            }
+            if (prev_edge == RoutesInternalData::NO_PREV_EDGE)
+            {
+                out += from != to;
+                continue;
+            }
+            const auto& edge = graph.GetEdge(prev_edge);
+            const uint32_t before_edge = actual.prev_edges[row + edge.from];
+            if (edge.to != to || before_edge == RoutesInternalData::NO_ROUTE
+                || std::fabs(actual.weights[row + edge.from] + edge.weight - weight) > WEIGHT_TOLERANCE)
+            {
+                ++out;
+            }
+        }
+    }
+    return out;
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t vertex_count = argc > 1 ? std::stoul(argv[1]) : 300;
+    const size_t out_degree = argc > 2 ? std::stoul(argv[2]) : 4;
+    const size_t step_count = argc > 3 ? std::stoul(argv[3]) : 6;
+    std::mt19937 random(argc > 4 ? std::stoul(argv[4]) : 1);
+
+    Graph graph = GenerateGraph(vertex_count, out_degree, random);
+    auto begin = Clock::now();
+    Router router(graph);
+    std::cout << vertex_count << " vertices, " << graph.GetEdgeCount() << " edges, build " << GetSeconds(begin) << " s\n";
+
+    size_t total_mismatches = 0;
+    for (size_t step = 0; step < step_count; ++step)
+    {
+        const std::vector<graph::EdgeId> changed_edges = ChangeWeights(graph, step % 3 + 1, random);
+
+        begin = Clock::now();
+        router.UpdateEdgeWeights(changed_edges);
+        const double update_time = GetSeconds(begin);
+
+        begin = Clock::now();
+        const Router rebuilt(graph);
+        const double rebuild_time = GetSeconds(begin);
+
+        const size_t mismatches = CountMismatches(graph, router, rebuilt);
+        total_mismatches += mismatches;
+        std::cout << "changed " << changed_edges.size() << " edges\tupdate " << update_time << " s\trebuild "
+                  << rebuild_time << " s\tmismatched cells " << mismatches << "\n";
+    }
+
+    return total_mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace chunked_storage
+{
+
+// Последовательность элементов в блоках по BLOCK_SIZE штук. Блок выделяется одним куском, когда
+// заполнен предыдущий, и больше не перемещается: указатели на элементы действительны до их
+// удаления, как у std::list. Элементы соседних номеров лежат рядом в памяти, номер элемента -
+// номер блока и смещение в нем. Удалять можно только последний элемент
+template <typename Value, size_t BLOCK_SIZE = 1024>
+class ChunkedStorage
+{
+    static_assert(BLOCK_SIZE > 0 && (BLOCK_SIZE & (BLOCK_SIZE - 1)) == 0, "BLOCK_SIZE should be a power of two");
+
+    template <typename Storage, typename Element>
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Element*;
+        using reference = Element&;
+
+        Iterator() = default;
+        Iterator(Storage* storage, size_t index)
+            : storage_(storage), index_(index)
+        {
+        }
+
+        reference operator*() const
+        {
+            return (*storage_)[index_];
+        }
+
+        pointer operator->() const
+        {
+            return &(*storage_)[index_];
+        }
+
+        Iterator& operator++()
+        {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator out = *this;
+            ++index_;
+            return out;
+        }
+
+        bool operator==(const Iterator& other) const
+        {
+            return index_ == other.index_ && storage_ == other.storage_;
+        }
+
+        bool operator!=(const Iterator& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        Storage* storage_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using value_type = Value;
+    using iterator = Iterator<ChunkedStorage, Value>;
+    using const_iterator = Iterator<const ChunkedStorage, const Value>;
+
+    ChunkedStorage() = default;
+
+    ChunkedStorage(const ChunkedStorage&) = delete;
+    ChunkedStorage& operator=(const ChunkedStorage&) = delete;
+
+    ~ChunkedStorage()
+    {
+        while (size_ != 0)
+        {
+            pop_back();
+        }
+    }
+
+    template <typename... Args>
+    Value& emplace_back(Args&&... args)
+    {
+        if (size_ == blocks_.size() * BLOCK_SIZE)
+        {
+            // без обнуления: память блока заполняется по мере добавления элементов
+            blocks_.push_back(std::unique_ptr<Slot[]>(new Slot[BLOCK_SIZE]));
+        }
+        Value* value = new (GetSlot(size_)) Value{std::forward<Args>(args)...};
+        ++size_;
+        return *value;
+    }
+
+    void push_back(const Value& value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(Value&& value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    // блок остается выделенным под следующие элементы
+    void pop_back()
+    {
+        --size_;
+        (*this)[size_].~Value();
+    }
+
+    Value& operator[](size_t index)
+    {
+        return *std::launder(reinterpret_cast<Value*>(GetSlot(index)));
+    }
+
+    const Value& operator[](size_t index) const
+    {
+        return *std::launder(reinterpret_cast<const Value*>(GetSlot(index)));
+    }
+
+    Value& back()
+    {
+        return (*this)[size_ - 1];
+    }
+
+    const Value& back() const
+    {
+        return (*this)[size_ - 1];
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    iterator begin()
+    {
+        return {this, 0};
+    }
+
+    iterator end()
+    {
+        return {this, size_};
+    }
+
+    const_iterator begin() const
+    {
+        return {this, 0};
+    }
+
+    const_iterator end() const
+    {
+        return {this, size_};
+    }
+
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+
+    const_iterator cend() const
+    {
+        return end();
+    }
+
+private:
+    struct Slot
+    {
+        alignas(Value) unsigned char bytes[sizeof(Value)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> blocks_;
+    size_t size_ = 0;
+
+    Slot* GetSlot(size_t index) const
+    {
+        return &blocks_[index / BLOCK_SIZE][index % BLOCK_SIZE];
+    }
+}; // end class ChunkedStorage
+
+} // end namespace chunked_storage
@@ -0,0 +1,619 @@
+#pragma once
+
+#include "dijkstra_router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Маршрутизатор на иерархиях сжатия (Contraction Hierarchies).
+// При построении вершины по очереди "сжимаются", а кратчайшие пути через сжатую вершину
+// заменяются ярлыками (shortcut). Запрос - двунаправленная Дейкстра только по ребрам,
+// ведущим к вершинам с большим рангом, после чего ярлыки разворачиваются в исходные ребра графа.
+// Веса ребер зашиты в ярлыки: после SetEdgeWeight иерархию нужно строить заново.
+template <typename Weight>
+class ContractionHierarchiesRouter final : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    // Ярлык заменяет пару ребер first_edge -> second_edge. Идентификаторы ребер
+    // меньше graph.GetEdgeCount() - исходные ребра графа, остальные - ярлыки со смещением
+    struct Shortcut {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId first_edge;
+        EdgeId second_edge;
+    };
+
+    struct Data
+    {
+        const std::vector<size_t>& ranks;
+        const std::vector<Shortcut>& shortcuts;
+    };
+
+    struct InitStruct
+    {
+        std::vector<size_t> ranks;
+        std::vector<Shortcut> shortcuts;
+    };
+
+    explicit ContractionHierarchiesRouter(const Graph& graph);
+    ContractionHierarchiesRouter(const Graph& graph, InitStruct&& init);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    // Без with_edges - поиск по корзинам: обратный поиск из каждой цели оставляет в посещенных
+    // вершинах записи (цель, вес), прямой поиск из источника сводит их в строку матрицы.
+    // С with_edges маршруты разворачиваются по одному через BuildRoute
+    std::vector<std::optional<RouteInfo>> BuildRouteMatrix(const std::vector<VertexId>& sources,
+                                                           const std::vector<VertexId>& targets, bool with_edges) const override;
+
+    Data GetData() const;
+
+private:
+
+    struct Arc {
+        VertexId vertex;
+        Weight weight;
+        EdgeId id;
+    };
+
+    struct SearchArcs {
+        std::vector<size_t> offsets;
+        std::vector<Arc> arcs;
+
+        ranges::Range<typename std::vector<Arc>::const_iterator> GetArcs(VertexId vertex) const {
+            return {arcs.begin() + offsets[vertex], arcs.begin() + offsets[vertex + 1]};
+        }
+    };
+
+    struct QueryScratch {
+        SearchScratch<Weight> forward;
+        SearchScratch<Weight> backward;
+    };
+
+    // запись корзины вершины: от вершины до цели target путь веса weight
+    struct BucketEntry {
+        size_t target;
+        Weight weight;
+    };
+
+    class Contractor;
+
+    using ScratchData = SearchScratch<Weight>;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr EdgeId NO_EDGE = ScratchData::NO_EDGE;
+    const Graph& graph_;
+    std::vector<size_t> ranks_;
+    std::vector<Shortcut> shortcuts_;
+    SearchArcs upward_;   // ребра к вершинам с большим рангом, для прямого поиска
+    SearchArcs downward_; // ребра от вершин с большим рангом, развернутые для обратного поиска
+
+    static QueryScratch& GetScratch() {
+        static thread_local QueryScratch scratch;
+        return scratch;
+    }
+
+    VertexId GetArcFrom(EdgeId id) const {
+        return id < graph_.GetEdgeCount() ? graph_.GetEdge(id).from : shortcuts_[id - graph_.GetEdgeCount()].from;
+    }
+
+    VertexId GetArcTo(EdgeId id) const {
+        return id < graph_.GetEdgeCount() ? graph_.GetEdge(id).to : shortcuts_[id - graph_.GetEdgeCount()].to;
+    }
+
+    void BuildSearchArcs();
+    void UnpackArc(EdgeId id, std::vector<EdgeId>& edges) const;
+    void CheckVertex(VertexId vertex) const;
+    // полный поиск без отсечения, для каждой извлеченной из кучи вершины вызывает on_settled
+    template <typename OnSettled>
+    void RunUpwardSearch(ScratchData& scratch, const SearchArcs& search_arcs, VertexId source, OnSettled on_settled) const;
+};
+
+// Построение иерархии: порядок сжатия выбирается по разнице ребер (edge difference)
+// с ленивым пересчетом приоритетов, лишние ярлыки отсекаются ограниченным поиском свидетелей
+template <typename Weight>
+class ContractionHierarchiesRouter<Weight>::Contractor {
+public:
+    Contractor(const Graph& graph, std::vector<size_t>& ranks, std::vector<Shortcut>& shortcuts)
+        : graph_(graph)
+        , ranks_(ranks)
+        , shortcuts_(shortcuts)
+        , out_arcs_(graph.GetVertexCount())
+        , in_arcs_(graph.GetVertexCount())
+        , deleted_neighbors_(graph.GetVertexCount(), 0)
+        , target_marks_(graph.GetVertexCount(), 0)
+        , target_weights_(graph.GetVertexCount())
+    {
+        // параллельные ребра схлопываются до самого легкого, при равенстве - с меньшим id
+        std::vector<EdgeId> edge_ids;
+        edge_ids.reserve(graph.GetEdgeCount());
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            if (edge.from != edge.to) {
+                edge_ids.push_back(edge_id);
+            }
+        }
+        std::sort(edge_ids.begin(), edge_ids.end(), [&graph](EdgeId lhs, EdgeId rhs) {
+            const auto& lhs_edge = graph.GetEdge(lhs);
+            const auto& rhs_edge = graph.GetEdge(rhs);
+            if (lhs_edge.from != rhs_edge.from || lhs_edge.to != rhs_edge.to) {
+                return std::pair{lhs_edge.from, lhs_edge.to} < std::pair{rhs_edge.from, rhs_edge.to};
+            }
+            if (lhs_edge.weight < rhs_edge.weight || rhs_edge.weight < lhs_edge.weight) {
+                return lhs_edge.weight < rhs_edge.weight;
+            }
+            return lhs < rhs;
+        });
+        for (size_t i = 0; i < edge_ids.size(); ++i) {
+            const auto& edge = graph.GetEdge(edge_ids[i]);
+            if (i > 0) {
+                const auto& prev_edge = graph.GetEdge(edge_ids[i - 1]);
+                if (prev_edge.from == edge.from && prev_edge.to == edge.to) {
+                    continue;
+                }
+            }
+            out_arcs_[edge.from].push_back({edge.to, edge.weight, edge_ids[i]});
+            in_arcs_[edge.to].push_back({edge.from, edge.weight, edge_ids[i]});
+        }
+    }
+
+    void Run() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        ranks_.assign(vertex_count, 0);
+
+        using Priority = std::pair<long long, VertexId>;
+        std::priority_queue<Priority, std::vector<Priority>, std::greater<Priority>> queue;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            queue.push({GetPriority(vertex), vertex});
+        }
+
+        size_t rank = 0;
+        while (!queue.empty()) {
+            const VertexId vertex = queue.top().second;
+            queue.pop();
+
+            // приоритет мог устареть после сжатия соседей
+            const long long priority = GetPriority(vertex);
+            if (!queue.empty() && priority > queue.top().first) {
+                queue.push({priority, vertex});
+                continue;
+            }
+
+            Contract(vertex);
+            ranks_[vertex] = rank++;
+        }
+    }
+
+private:
+
+    struct ContractionArc {
+        VertexId vertex;
+        Weight weight;
+        EdgeId id;
+    };
+
+    // ограничения поиска свидетелей: за ними ярлык добавляется без дальнейшей проверки.
+    // Лимит просмотренных ребер не дает поиску вырождаться на плотных графах
+    static constexpr size_t WITNESS_SETTLE_LIMIT = 100;
+    static constexpr size_t WITNESS_ARC_LIMIT = 2000;
+
+    const Graph& graph_;
+    std::vector<size_t>& ranks_;
+    std::vector<Shortcut>& shortcuts_;
+    std::vector<std::vector<ContractionArc>> out_arcs_;
+    std::vector<std::vector<ContractionArc>> in_arcs_;
+    std::vector<size_t> deleted_neighbors_;
+    ScratchData witness_;
+    std::vector<uint32_t> target_marks_;
+    std::vector<Weight> target_weights_;
+    uint32_t target_mark_ = 0;
+
+    // Между парой вершин хранится одно, самое легкое ребро
+    void AddArc(VertexId from, VertexId to, Weight weight, EdgeId id) {
+        auto& out_arcs = out_arcs_[from];
+        const auto iter = std::find_if(out_arcs.begin(), out_arcs.end(), [to](const ContractionArc& arc) {
+            return arc.vertex == to;
+        });
+        if (iter == out_arcs.end()) {
+            out_arcs.push_back({to, weight, id});
+            in_arcs_[to].push_back({from, weight, id});
+            return;
+        }
+        if (!(weight < iter->weight)) {
+            return;
+        }
+        *iter = {to, weight, id};
+        for (auto& arc : in_arcs_[to]) {
+            if (arc.vertex == from) {
+                arc = {from, weight, id};
+                break;
+            }
+        }
+    }
+
+    // Ищет пути-свидетели из source в обход excluded. Поиск останавливается, как только
+    // для всех целей найден путь не длиннее пути через excluded
+    void RunWitnessSearch(VertexId source, VertexId excluded, Weight max_weight, size_t target_count) {
+        witness_.Prepare(graph_.GetVertexCount());
+        witness_.Relax(source, ZERO_WEIGHT, NO_EDGE);
+
+        size_t uncovered = target_count;
+        size_t settled = 0;
+        size_t scanned = 0;
+        while (!witness_.heap.empty()) {
+            const auto item = witness_.Pop();
+            if (witness_.IsStale(item)) {
+                continue;
+            }
+            if (max_weight < item.weight || ++settled > WITNESS_SETTLE_LIMIT || scanned > WITNESS_ARC_LIMIT) {
+                break;
+            }
+            scanned += out_arcs_[item.vertex].size();
+            for (const auto& arc : out_arcs_[item.vertex]) {
+                if (arc.vertex == excluded || !witness_.Relax(arc.vertex, item.weight + arc.weight, arc.id)) {
+                    continue;
+                }
+                if (target_marks_[arc.vertex] == target_mark_ && !(target_weights_[arc.vertex] < witness_.weights[arc.vertex])) {
+                    target_marks_[arc.vertex] = 0;
+                    if (--uncovered == 0) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    // Считает (или добавляет, если apply == true) ярлыки, нужные при сжатии вершины
+    size_t ProcessShortcuts(VertexId vertex, bool apply) {
+        size_t shortcut_count = 0;
+        for (const auto& in_arc : in_arcs_[vertex]) {
+            // из вершины с единственным исходящим ребром (в vertex) обходного пути нет
+            const bool need_search = out_arcs_[in_arc.vertex].size() > 1;
+
+            NextTargetMark();
+            Weight max_weight = ZERO_WEIGHT;
+            size_t target_count = 0;
+            for (const auto& out_arc : out_arcs_[vertex]) {
+                if (out_arc.vertex == in_arc.vertex) {
+                    continue;
+                }
+                const Weight candidate_weight = in_arc.weight + out_arc.weight;
+                target_marks_[out_arc.vertex] = target_mark_;
+                target_weights_[out_arc.vertex] = candidate_weight;
+                // как и в вершину с единственным входящим ребром (из vertex)
+                if (in_arcs_[out_arc.vertex].size() > 1) {
+                    ++target_count;
+                    if (max_weight < candidate_weight) {
+                        max_weight = candidate_weight;
+                    }
+                }
+            }
+
+            if (need_search && target_count > 0) {
+                RunWitnessSearch(in_arc.vertex, vertex, max_weight, target_count);
+            }
+
+            for (const auto& out_arc : out_arcs_[vertex]) {
+                if (target_marks_[out_arc.vertex] != target_mark_) {
+                    continue; // путь-свидетель найден
+                }
+                ++shortcut_count;
+                if (apply) {
+                    const Weight candidate_weight = in_arc.weight + out_arc.weight;
+                    shortcuts_.push_back({in_arc.vertex, out_arc.vertex, candidate_weight, in_arc.id, out_arc.id});
+                    AddArc(in_arc.vertex, out_arc.vertex, candidate_weight, graph_.GetEdgeCount() + shortcuts_.size() - 1);
+                }
+            }
+        }
+        return shortcut_count;
+    }
+
+    void NextTargetMark() {
+        if (++target_mark_ == 0) {
+            std::fill(target_marks_.begin(), target_marks_.end(), 0);
+            target_mark_ = 1;
+        }
+    }
+
+    long long GetPriority(VertexId vertex) {
+        const long long shortcut_count = static_cast<long long>(ProcessShortcuts(vertex, false));
+        const long long arc_count = static_cast<long long>(in_arcs_[vertex].size() + out_arcs_[vertex].size());
+        return shortcut_count - arc_count + static_cast<long long>(deleted_neighbors_[vertex]);
+    }
+
+    void Contract(VertexId vertex) {
+        ProcessShortcuts(vertex, true);
+
+        auto remove_arcs_to = [vertex](std::vector<ContractionArc>& arcs) {
+            arcs.erase(std::remove_if(arcs.begin(), arcs.end(), [vertex](const ContractionArc& arc) {
+                return arc.vertex == vertex;
+            }), arcs.end());
+        };
+
+        for (const auto& arc : in_arcs_[vertex]) {
+            remove_arcs_to(out_arcs_[arc.vertex]);
+            ++deleted_neighbors_[arc.vertex];
+        }
+        for (const auto& arc : out_arcs_[vertex]) {
+            remove_arcs_to(in_arcs_[arc.vertex]);
+            ++deleted_neighbors_[arc.vertex];
+        }
+
+        std::vector<ContractionArc>{}.swap(in_arcs_[vertex]);
+        std::vector<ContractionArc>{}.swap(out_arcs_[vertex]);
+    }
+};
+
+template <typename Weight>
+ContractionHierarchiesRouter<Weight>::ContractionHierarchiesRouter(const Graph& graph)
+    : graph_(graph)
+{
+    Contractor{graph, ranks_, shortcuts_}.Run();
+    BuildSearchArcs();
+}
+
+template <typename Weight>
+ContractionHierarchiesRouter<Weight>::ContractionHierarchiesRouter(const Graph& graph, InitStruct&& init)
+    : graph_(graph), ranks_(std::move(init.ranks)), shortcuts_(std::move(init.shortcuts))
+{
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (ranks_.size() != vertex_count) {
+        throw std::invalid_argument("Contraction hierarchies don't match the graph");
+    }
+    // ранги, ярлыки и их ребра из другой или поврежденной базы отклоняются здесь, а не при поиске
+    std::vector<bool> is_rank_used(vertex_count, false);
+    for (const size_t rank : ranks_) {
+        if (rank >= vertex_count || is_rank_used[rank]) {
+            throw std::invalid_argument("Contraction hierarchy ranks are not a permutation of the vertices");
+        }
+        is_rank_used[rank] = true;
+    }
+    // ярлык заменяет ребра, созданные раньше него, поэтому разворачивание ярлыков конечно
+    for (size_t i = 0; i < shortcuts_.size(); ++i) {
+        const Shortcut& shortcut = shortcuts_[i];
+        const size_t arc_count = graph_.GetEdgeCount() + i;
+        if (shortcut.from >= vertex_count || shortcut.to >= vertex_count
+            || shortcut.first_edge >= arc_count || shortcut.second_edge >= arc_count
+            || GetArcFrom(shortcut.first_edge) != shortcut.from || GetArcTo(shortcut.first_edge) != GetArcFrom(shortcut.second_edge)
+            || GetArcTo(shortcut.second_edge) != shortcut.to) {
+            throw std::invalid_argument("Contraction hierarchy shortcut doesn't match the graph");
+        }
+    }
+    BuildSearchArcs();
+}
+
+template <typename Weight>
+void ContractionHierarchiesRouter<Weight>::BuildSearchArcs() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    const size_t arc_count = graph_.GetEdgeCount() + shortcuts_.size();
+
+    upward_.offsets.assign(vertex_count + 1, 0);
+    downward_.offsets.assign(vertex_count + 1, 0);
+
+    for (EdgeId id = 0; id < arc_count; ++id) {
+        const VertexId from = GetArcFrom(id);
+        const VertexId to = GetArcTo(id);
+        if (from == to) {
+            continue;
+        }
+        if (ranks_[from] < ranks_[to]) {
+            ++upward_.offsets[from + 1];
+        } else {
+            ++downward_.offsets[to + 1];
+        }
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        upward_.offsets[vertex + 1] += upward_.offsets[vertex];
+        downward_.offsets[vertex + 1] += downward_.offsets[vertex];
+    }
+
+    upward_.arcs.resize(upward_.offsets.back());
+    downward_.arcs.resize(downward_.offsets.back());
+    std::vector<size_t> up_pos(upward_.offsets.begin(), upward_.offsets.end() - 1);
+    std::vector<size_t> down_pos(downward_.offsets.begin(), downward_.offsets.end() - 1);
+
+    for (EdgeId id = 0; id < arc_count; ++id) {
+        const VertexId from = GetArcFrom(id);
+        const VertexId to = GetArcTo(id);
+        if (from == to) {
+            continue;
+        }
+        const Weight weight = id < graph_.GetEdgeCount() ? graph_.GetEdge(id).weight : shortcuts_[id - graph_.GetEdgeCount()].weight;
+        if (ranks_[from] < ranks_[to]) {
+            upward_.arcs[up_pos[from]++] = {to, weight, id};
+        } else {
+            downward_.arcs[down_pos[to]++] = {from, weight, id};
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchiesRouter<Weight>::UnpackArc(EdgeId id, std::vector<EdgeId>& edges) const {
+    std::vector<EdgeId> stack{id};
+    while (!stack.empty()) {
+        const EdgeId current = stack.back();
+        stack.pop_back();
+        if (current < graph_.GetEdgeCount()) {
+            edges.push_back(current);
+        } else {
+            const Shortcut& shortcut = shortcuts_[current - graph_.GetEdgeCount()];
+            stack.push_back(shortcut.second_edge);
+            stack.push_back(shortcut.first_edge);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchiesRouter<Weight>::RouteInfo> ContractionHierarchiesRouter<Weight>::BuildRoute(VertexId from,
+                                                                                                                       VertexId to) const {
+    CheckVertex(from);
+    CheckVertex(to);
+    const size_t vertex_count = graph_.GetVertexCount();
+
+    QueryScratch& scratch = GetScratch();
+    scratch.forward.Prepare(vertex_count);
+    scratch.backward.Prepare(vertex_count);
+    scratch.forward.Relax(from, ZERO_WEIGHT, NO_EDGE);
+    scratch.backward.Relax(to, ZERO_WEIGHT, NO_EDGE);
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+
+    while (!scratch.forward.heap.empty() || !scratch.backward.heap.empty()) {
+        // продолжаем направление с меньшим ключом в куче
+        const bool is_forward = !scratch.forward.heap.empty()
+            && (scratch.backward.heap.empty() || !(scratch.backward.heap.front().weight < scratch.forward.heap.front().weight));
+        ScratchData& current = is_forward ? scratch.forward : scratch.backward;
+        const ScratchData& opposite = is_forward ? scratch.backward : scratch.forward;
+
+        const auto item = current.Pop();
+        if (current.IsStale(item)) {
+            continue;
+        }
+        if (best_weight && !(item.weight < *best_weight)) {
+            current.heap.clear();
+            continue;
+        }
+
+        if (opposite.IsReached(item.vertex)) {
+            const Weight candidate_weight = item.weight + opposite.weights[item.vertex];
+            if (!best_weight || candidate_weight < *best_weight) {
+                best_weight = candidate_weight;
+                meeting_vertex = item.vertex;
+            }
+        }
+
+        for (const Arc& arc : (is_forward ? upward_ : downward_).GetArcs(item.vertex)) {
+            current.Relax(arc.vertex, item.weight + arc.weight, arc.id);
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> arcs;
+    for (VertexId vertex = meeting_vertex; scratch.forward.prev_edges[vertex] != NO_EDGE;
+         vertex = GetArcFrom(arcs.back()))
+    {
+        arcs.push_back(scratch.forward.prev_edges[vertex]);
+    }
+    std::reverse(arcs.begin(), arcs.end());
+    for (VertexId vertex = meeting_vertex; scratch.backward.prev_edges[vertex] != NO_EDGE;
+         vertex = GetArcTo(arcs.back()))
+    {
+        arcs.push_back(scratch.backward.prev_edges[vertex]);
+    }
+
+    std::vector<EdgeId> edges;
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId arc : arcs) {
+        UnpackArc(arc, edges);
+    }
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight>
+std::vector<std::optional<typename ContractionHierarchiesRouter<Weight>::RouteInfo>>
+ContractionHierarchiesRouter<Weight>::BuildRouteMatrix(const std::vector<VertexId>& sources,
+                                                       const std::vector<VertexId>& targets, bool with_edges) const {
+    if (with_edges) {
+        return RouterBase<Weight>::BuildRouteMatrix(sources, targets, with_edges);
+    }
+    const size_t vertex_count = graph_.GetVertexCount();
+    for (const VertexId vertex : sources) {
+        CheckVertex(vertex);
+    }
+    for (const VertexId vertex : targets) {
+        CheckVertex(vertex);
+    }
+
+    QueryScratch& scratch = GetScratch();
+
+    // корзины раскладываются по вершинам как CSR: bucket_offsets[v] .. bucket_offsets[v + 1]
+    std::vector<std::pair<VertexId, BucketEntry>> entries;
+    for (size_t target = 0; target < targets.size(); ++target) {
+        RunUpwardSearch(scratch.backward, downward_, targets[target], [&entries, target](VertexId vertex, Weight weight) {
+            entries.push_back({vertex, {target, weight}});
+        });
+    }
+    std::vector<size_t> bucket_offsets(vertex_count + 1, 0);
+    for (const auto& [vertex, entry] : entries) {
+        ++bucket_offsets[vertex + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        bucket_offsets[vertex + 1] += bucket_offsets[vertex];
+    }
+    std::vector<BucketEntry> buckets(entries.size());
+    std::vector<size_t> cursors(bucket_offsets.begin(), bucket_offsets.end() - 1);
+    for (const auto& [vertex, entry] : entries) {
+        buckets[cursors[vertex]++] = entry;
+    }
+
+    std::vector<std::optional<RouteInfo>> out(sources.size() * targets.size());
+    for (size_t source = 0; source < sources.size(); ++source) {
+        std::optional<RouteInfo>* row = out.data() + source * targets.size();
+        RunUpwardSearch(scratch.forward, upward_, sources[source], [&](VertexId vertex, Weight weight) {
+            for (size_t i = bucket_offsets[vertex]; i < bucket_offsets[vertex + 1]; ++i) {
+                const Weight candidate_weight = weight + buckets[i].weight;
+                std::optional<RouteInfo>& cell = row[buckets[i].target];
+                if (!cell || candidate_weight < cell->weight) {
+                    cell = RouteInfo{candidate_weight, {}};
+                }
+            }
+        });
+    }
+    return out;
+}
+
+template <typename Weight>
+template <typename OnSettled>
+void ContractionHierarchiesRouter<Weight>::RunUpwardSearch(ScratchData& scratch, const SearchArcs& search_arcs,
+                                                           VertexId source, OnSettled on_settled) const {
+    scratch.Prepare(graph_.GetVertexCount());
+    scratch.Relax(source, ZERO_WEIGHT, NO_EDGE);
+    while (!scratch.heap.empty()) {
+        const auto item = scratch.Pop();
+        if (scratch.IsStale(item)) {
+            continue;
+        }
+        on_settled(item.vertex, item.weight);
+        for (const Arc& arc : search_arcs.GetArcs(item.vertex)) {
+            scratch.Relax(arc.vertex, item.weight + arc.weight, arc.id);
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchiesRouter<Weight>::CheckVertex(VertexId vertex) const {
+    if (vertex >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+}
+
+template <typename Weight>
+typename ContractionHierarchiesRouter<Weight>::Data ContractionHierarchiesRouter<Weight>::GetData() const
+{
+    return {ranks_, shortcuts_};
+}
+
+}  // namespace graph
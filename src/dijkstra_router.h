@@ -0,0 +1,171 @@
+#pragma once
+
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+// Маршрутизатор без предрасчета: каждый запрос BuildRoute решается поиском Дейкстры
+// по графу с бинарной кучей. Память O(V + E) вместо O(V^2) у Router.
+// Веса читаются из графа при каждом запросе, после SetEdgeWeight пересчитывать нечего
+template <typename Weight>
+class DijkstraRouter final : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    explicit DijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    // один поиск на каждую вершину sources, до извлечения из кучи всех targets
+    std::vector<std::optional<RouteInfo>> BuildRouteMatrix(const std::vector<VertexId>& sources,
+                                                           const std::vector<VertexId>& targets, bool with_edges) const override;
+
+private:
+
+    using ScratchData = SearchScratch<Weight>;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr EdgeId NO_EDGE = ScratchData::NO_EDGE;
+    const Graph& graph_;
+
+    static ScratchData& GetScratch() {
+        static thread_local ScratchData scratch;
+        return scratch;
+    }
+
+    void CheckVertex(VertexId vertex) const;
+    std::vector<EdgeId> CollectEdges(const ScratchData& scratch, VertexId to) const;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    if (!graph.IsFrozen()) {
+        throw std::logic_error("Graph should be frozen before routing");
+    }
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+                                                                                           VertexId to) const {
+    CheckVertex(from);
+    CheckVertex(to);
+    const size_t vertex_count = graph_.GetVertexCount();
+
+    ScratchData& scratch = GetScratch();
+    scratch.Prepare(vertex_count);
+
+    scratch.Relax(from, ZERO_WEIGHT, NO_EDGE);
+
+    while (!scratch.heap.empty()) {
+        const auto item = scratch.Pop();
+
+        if (scratch.IsStale(item)) {
+            continue;
+        }
+        if (item.vertex == to) {
+            break;
+        }
+
+        const auto outgoing = graph_.GetOutgoingEdges(item.vertex);
+        for (size_t i = 0; i < outgoing.count; ++i) {
+            scratch.Relax(outgoing.targets[i], item.weight + outgoing.weights[i], outgoing.edge_ids[i]);
+        }
+    }
+
+    if (!scratch.IsReached(to)) {
+        return std::nullopt;
+    }
+
+    return RouteInfo{scratch.weights[to], CollectEdges(scratch, to)};
+}
+
+template <typename Weight>
+std::vector<std::optional<typename DijkstraRouter<Weight>::RouteInfo>> DijkstraRouter<Weight>::BuildRouteMatrix(
+    const std::vector<VertexId>& sources, const std::vector<VertexId>& targets, bool with_edges) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    for (const VertexId vertex : sources) {
+        CheckVertex(vertex);
+    }
+
+    std::vector<char> is_target(vertex_count, 0);
+    size_t target_count = 0;
+    for (const VertexId vertex : targets) {
+        CheckVertex(vertex);
+        if (!is_target[vertex]) {
+            is_target[vertex] = 1;
+            ++target_count;
+        }
+    }
+    // settled_marks[v] == номер поиска + 1, если цель v уже извлечена из кучи в этом поиске
+    std::vector<size_t> settled_marks(vertex_count, 0);
+
+    std::vector<std::optional<RouteInfo>> out;
+    out.reserve(sources.size() * targets.size());
+    ScratchData& scratch = GetScratch();
+    for (size_t source = 0; source < sources.size(); ++source) {
+        scratch.Prepare(vertex_count);
+        scratch.Relax(sources[source], ZERO_WEIGHT, NO_EDGE);
+
+        size_t remaining = target_count;
+        while (!scratch.heap.empty() && remaining != 0) {
+            const auto item = scratch.Pop();
+            if (scratch.IsStale(item)) {
+                continue;
+            }
+            if (is_target[item.vertex] && settled_marks[item.vertex] != source + 1) {
+                settled_marks[item.vertex] = source + 1;
+                --remaining;
+            }
+
+            const auto outgoing = graph_.GetOutgoingEdges(item.vertex);
+            for (size_t i = 0; i < outgoing.count; ++i) {
+                scratch.Relax(outgoing.targets[i], item.weight + outgoing.weights[i], outgoing.edge_ids[i]);
+            }
+        }
+
+        for (const VertexId to : targets) {
+            if (!scratch.IsReached(to)) {
+                out.push_back(std::nullopt);
+            } else {
+                out.push_back(RouteInfo{scratch.weights[to], with_edges ? CollectEdges(scratch, to) : std::vector<EdgeId>{}});
+            }
+        }
+    }
+    return out;
+}
+
+template <typename Weight>
+void DijkstraRouter<Weight>::CheckVertex(VertexId vertex) const {
+    if (vertex >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+}
+
+template <typename Weight>
+std::vector<EdgeId> DijkstraRouter<Weight>::CollectEdges(const ScratchData& scratch, VertexId to) const {
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = scratch.prev_edges[to]; edge_id != NO_EDGE;
+         edge_id = scratch.prev_edges[graph_.GetEdge(edge_id).from])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return edges;
+}
+
+}  // namespace graph
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "geo.h"
@@ -10,30 +11,41 @@ namespace domain
 
 enum class BussRootType {CYCLE, FORWARD};
 
+// Имена остановок и маршрутов в базе указывают в пул строк каталога.
+// До добавления в каталог name ссылается на входные данные, которые должны быть живы
 struct Stop
 {
-    Stop(std::string name_in, geo::Coordinates coordinates_in): name(std::move(name_in)), coordinates(coordinates_in) {}
+    Stop(std::string_view name_in, geo::Coordinates coordinates_in): name(name_in), coordinates(coordinates_in) {}
     
-    std::string name;
+    std::string_view name;
     geo::Coordinates coordinates;
     size_t id = 0;
 }; // struct Stop
 
+// Показатели маршрута, считаются один раз при добавлении автобуса в базу
+struct BusStats
+{
+    unsigned int route_length = 0;
+    double distance = 0;
+    double curvature = 0;
+    int stop_count = 0;
+    int unique_stop_count = 0;
+}; // struct BusStats
+
 struct Bus
 {
-    std::string name;
+    std::string_view name;
     std::vector<const Stop*> stops;
     double distance = 0;
     BussRootType root_type = BussRootType::FORWARD;
     size_t id = 0;
+    BusStats stats;
+    // Расстояния по дорогам между соседними остановками, считаются при добавлении в базу:
+    // hop_lengths[i] - от stops[i] до stops[i + 1], reverse_hop_lengths[i] - от stops[i + 1]
+    // до stops[i], только для маршрута FORWARD
+    std::vector<unsigned int> hop_lengths;
+    std::vector<unsigned int> reverse_hop_lengths;
 }; // struct Bus
 
-struct StopPairHasher
-{
-    size_t operator() (const std::pair<const Stop*, const Stop*>& input_pair) const noexcept
-    {
-        return std::hash<const void*>{}(input_pair.first) + std::hash<const void*>{}(input_pair.second);
-    }
-}; // struct StopPairHasher
 } // end namespace domain
 
@@ -2,7 +2,10 @@
 
 #include "ranges.h"
 
+#include <cstdint>
 #include <cstdlib>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -17,10 +20,26 @@ struct Edge {
     Weight weight;
 };
 
+// Соответствие прежнего графа новому после изменения базы: vertices[old] и edges[old] -
+// номера в новом графе, NO_VERTEX и NO_EDGE - вершины или ребра в новом графе нет
+struct GraphMapping {
+    static constexpr VertexId NO_VERTEX = static_cast<VertexId>(-1);
+    static constexpr EdgeId NO_EDGE = static_cast<EdgeId>(-1);
+
+    std::vector<VertexId> vertices;
+    std::vector<EdgeId> edges;
+};
+
+// Граф строится добавлением ребер, после Freeze исходящие ребра хранятся в виде CSR: ребра
+// отсортированы по началу, концы, веса и номера ребер лежат в отдельных непрерывных массивах,
+// offsets_[v] .. offsets_[v + 1] - ребра вершины v. Обход ребер доступен только после Freeze.
+// Номера вершин и ребер в CSR 32-битные: массивы обходятся в каждом поиске, вдвое меньшие
+// массивы меньше вытесняют из кэша таблицы расстояний
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
-    using IncidenceList = std::vector<EdgeId>;
+    using CsrIndex = uint32_t;
+    using IncidenceList = std::vector<CsrIndex>;
     using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
 
 public:
@@ -28,47 +47,132 @@ public:
     struct InitStruct
     {
         std::vector<Edge<Weight>> edges;
-        std::vector<IncidenceList> incidence_lists;
+        size_t vertex_count = 0;
     };
 
     struct Data
     {
         const std::vector<Edge<Weight>>& edges;
-        const std::vector<IncidenceList>& incident_lists;
+        size_t vertex_count;
+    };
+
+    // исходящие ребра вершины: i-е ребро ведет в targets[i] с весом weights[i]
+    struct OutgoingEdges {
+        const CsrIndex* targets;
+        const Weight* weights;
+        const CsrIndex* edge_ids;
+        size_t count;
     };
 
     DirectedWeightedGraph() = default;
-    DirectedWeightedGraph(InitStruct&& init): edges_(std::move(init.edges)), incidence_lists_(std::move(init.incidence_lists)) {};
+    DirectedWeightedGraph(InitStruct&& init);
     explicit DirectedWeightedGraph(size_t vertex_count);
     EdgeId AddEdge(const Edge<Weight>& edge);
+    // раскладывает ребра в CSR, до следующего AddEdge. Вершин и ребер должно быть меньше 2^32
+    void Freeze();
+    bool IsFrozen() const;
+    // маршрутизаторы с предрасчетом нужно уведомить об изменении, см. Router::UpdateEdgeWeights
+    void SetEdgeWeight(EdgeId edge_id, const Weight& weight);
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+    // без проверки границ, для циклов поиска
+    OutgoingEdges GetOutgoingEdges(VertexId vertex) const;
     Data GetData() const;
 
 private:
+    size_t vertex_count_ = 0;
     std::vector<Edge<Weight>> edges_;
-    std::vector<IncidenceList> incidence_lists_;
+
+    bool is_frozen_ = false;
+    std::vector<CsrIndex> offsets_;
+    std::vector<CsrIndex> targets_;
+    std::vector<Weight> weights_;
+    std::vector<CsrIndex> edge_ids_;
+
+    void CheckFrozen() const;
 };
 
+template <typename Weight>
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(InitStruct&& init)
+    : vertex_count_(init.vertex_count)
+    , edges_(std::move(init.edges)) {
+    for (const auto& edge : edges_) {
+        if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+            throw std::out_of_range("Edge vertex is out of graph");
+        }
+    }
+    Freeze();
+}
+
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+    : vertex_count_(vertex_count) {
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+        throw std::out_of_range("Edge vertex is out of graph");
+    }
     edges_.push_back(edge);
-    const EdgeId id = edges_.size() - 1;
-    incidence_lists_.at(edge.from).push_back(id);
-    return id;
+    is_frozen_ = false;
+    return edges_.size() - 1;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if (vertex_count_ >= std::numeric_limits<CsrIndex>::max() || edges_.size() >= std::numeric_limits<CsrIndex>::max()) {
+        throw std::length_error("Too many vertices or edges for the graph");
+    }
+    // сортировка подсчетом устойчива: у вершины ребра идут по возрастанию номеров, как добавлялись
+    offsets_.assign(vertex_count_ + 1, 0);
+    for (const auto& edge : edges_) {
+        ++offsets_[edge.from + 1];
+    }
+    for (size_t vertex = 0; vertex < vertex_count_; ++vertex) {
+        offsets_[vertex + 1] += offsets_[vertex];
+    }
+
+    targets_.resize(edges_.size());
+    weights_.resize(edges_.size());
+    edge_ids_.resize(edges_.size());
+    std::vector<CsrIndex> cursors(offsets_.begin(), offsets_.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        const auto& edge = edges_[edge_id];
+        const CsrIndex position = cursors[edge.from]++;
+        targets_[position] = static_cast<CsrIndex>(edge.to);
+        weights_[position] = edge.weight;
+        edge_ids_[position] = static_cast<CsrIndex>(edge_id);
+    }
+    is_frozen_ = true;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return is_frozen_;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, const Weight& weight) {
+    auto& edge = edges_.at(edge_id);
+    edge.weight = weight;
+    if (!is_frozen_) {
+        return;
+    }
+    for (size_t position = offsets_[edge.from]; position < offsets_[edge.from + 1]; ++position) {
+        if (edge_ids_[position] == edge_id) {
+            weights_[position] = weight;
+            return;
+        }
+    }
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return vertex_count_;
 }
 
 template <typename Weight>
@@ -84,13 +188,28 @@ const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-    return ranges::AsRange(incidence_lists_.at(vertex));
+    CheckFrozen();
+    return {edge_ids_.begin() + offsets_.at(vertex), edge_ids_.begin() + offsets_.at(vertex + 1)};
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::OutgoingEdges
+DirectedWeightedGraph<Weight>::GetOutgoingEdges(VertexId vertex) const {
+    const CsrIndex begin = offsets_[vertex];
+    return {targets_.data() + begin, weights_.data() + begin, edge_ids_.data() + begin, offsets_[vertex + 1] - begin};
 }
 
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::Data DirectedWeightedGraph<Weight>::GetData() const
 {
-    return {edges_, incidence_lists_};
+    return {edges_, vertex_count_};
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::CheckFrozen() const {
+    if (!is_frozen_) {
+        throw std::logic_error("Graph should be frozen before traversal");
+    }
 }
 
-}  // namespace graph
\ No newline at end of file
+}  // namespace graph
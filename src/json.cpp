@@ -1,4 +1,19 @@
+#include <cctype>
+#include <charconv>
+#include <cstring>
 #include <iterator>
+#include <type_traits>
+#include <unordered_set>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSON_USE_SSE2
+#endif
+#if (defined(__AVX2__) || defined(JSON_USE_SSE2)) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
 
 #include "json.h"
 
@@ -7,234 +22,490 @@ namespace json {
 namespace {
 using namespace std::literals;
 
-Node LoadNode(std::istream& input);
-Node LoadString(std::istream& input);
-
-std::string LoadLiteral(std::istream& input) {
-    std::string s;
-    while (std::isalpha(input.peek())) {
-        s.push_back(static_cast<char>(input.get()));
+#if defined(__AVX2__) || defined(JSON_USE_SSE2)
+// номер младшего установленного бита, mask != 0
+unsigned CountTrailingZeros(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+// Ищет первый символ строки, который требует разбора: кавычку, обратную косую черту
+// или перевод строки. Блоки по 32/16 байт проверяются векторно, хвост - побайтно
+const char* FindStringSpecial(const char* pos, const char* end) {
+#if defined(__AVX2__)
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i line_feed = _mm256_set1_epi8('\n');
+    const __m256i carriage_return = _mm256_set1_epi8('\r');
+    for (; end - pos >= 32; pos += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+        const __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, line_feed), _mm256_cmpeq_epi8(chunk, carriage_return)));
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if (mask != 0) {
+            return pos + CountTrailingZeros(mask);
+        }
     }
-    return s;
+#elif defined(JSON_USE_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i line_feed = _mm_set1_epi8('\n');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    for (; end - pos >= 16; pos += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        const __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, line_feed), _mm_cmpeq_epi8(chunk, carriage_return)));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return pos + CountTrailingZeros(mask);
+        }
+    }
+#endif
+    for (; pos != end; ++pos) {
+        const char c = *pos;
+        if (c == '"' || c == '\\' || c == '\n' || c == '\r') {
+            break;
+        }
+    }
+    return pos;
 }
 
-Node LoadArray(std::istream& input) {
-    std::vector<Node> result;
+// Разбор документа из непрерывного буфера. Грамматика и сообщения об ошибках
+// совпадают с прежним разбором из потока
+class Parser {
+public:
+    Parser(const char* begin, const char* end, std::pmr::memory_resource* resource)
+        : pos_(begin)
+        , end_(end)
+        , resource_(resource) {
+    }
 
-    for (char c; input >> c && c != ']';) {
-        if (c != ',') {
-            input.putback(c);
+    Node LoadRoot(const ArrayHandlers& handlers) {
+        char c;
+        if (!NextNonSpace(c)) {
+            throw ParsingError("Unexpected EOF"s);
+        }
+        if (c == '{') {
+            return LoadDict(&handlers);
         }
-        result.push_back(LoadNode(input));
+        --pos_;
+        return LoadNode();
     }
-    if (!input) {
-        throw ParsingError("Array parsing error"s);
+
+    Node LoadNode() {
+        char c;
+        if (!NextNonSpace(c)) {
+            throw ParsingError("Unexpected EOF"s);
+        }
+        switch (c) {
+            case '[':
+                return LoadArray();
+            case '{':
+                return LoadDict();
+            case '"':
+                return LoadString();
+            case 't':
+                [[fallthrough]];
+            case 'f':
+                --pos_;
+                return LoadBool();
+            case 'n':
+                --pos_;
+                return LoadNull();
+            default:
+                --pos_;
+                return LoadNumber();
+        }
+    }
+
+private:
+    const char* pos_;
+    const char* end_;
+    std::pmr::memory_resource* resource_;
+    // элементы еще не закрытых массивов и пары словарей всех уровней вложенности
+    std::vector<Node> array_items_;
+    std::vector<Dict::value_type> dict_items_;
+
+    // тот же набор, что у std::isspace в локали "C"
+    static bool IsSpace(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    static bool IsDigit(char c) {
+        return c >= '0' && c <= '9';
     }
-    return Node(std::move(result));
-}
 
-Node LoadDict(std::istream& input) {
-    Dict dict;
+    // аналог input >> c: пропускает пробельные символы и читает следующий
+    bool NextNonSpace(char& c) {
+        while (pos_ != end_ && IsSpace(*pos_)) {
+            ++pos_;
+        }
+        if (pos_ == end_) {
+            return false;
+        }
+        c = *pos_++;
+        return true;
+    }
 
-    for (char c; input >> c && c != '}';) {
-        if (c == '"') {
-            std::string key = LoadString(input).AsString();
-            if (input >> c && c == ':') {
-                if (dict.find(key) != dict.end()) {
-                    throw ParsingError("Duplicate key '"s + key + "' have been found");
+    int Peek() const {
+        return pos_ != end_ ? static_cast<unsigned char>(*pos_) : EOF;
+    }
+
+    std::string_view LoadLiteral() {
+        const char* begin = pos_;
+        while (pos_ != end_ && std::isalpha(static_cast<unsigned char>(*pos_))) {
+            ++pos_;
+        }
+        return {begin, static_cast<size_t>(pos_ - begin)};
+    }
+
+    // Разбирает элементы массива после '[' и передает каждый в sink
+    template <typename Sink>
+    void LoadArrayItems(Sink&& sink) {
+        char c;
+        bool closed = false;
+        while (NextNonSpace(c)) {
+            if (c == ']') {
+                closed = true;
+                break;
+            }
+            if (c != ',') {
+                --pos_;
+            }
+            sink(LoadNode());
+        }
+        if (!closed) {
+            throw ParsingError("Array parsing error"s);
+        }
+    }
+
+    Node LoadArray() {
+        // как и пары словарей, элементы копятся в общем стеке, а массив выделяется один раз
+        // точного размера - в арене не остаются брошенные при росте буферы
+        const size_t items_begin = array_items_.size();
+        LoadArrayItems([this](Node&& node) {
+            array_items_.push_back(std::move(node));
+        });
+        Array result(resource_);
+        result.reserve(array_items_.size() - items_begin);
+        std::move(array_items_.begin() + items_begin, array_items_.end(), std::back_inserter(result));
+        array_items_.resize(items_begin);
+        return Node(std::move(result));
+    }
+
+    // Значение по ключу корневого словаря: массив с обработчиком не накапливается,
+    // его элементы сразу уходят обработчику, а в документе остается пустой массив
+    Node LoadRootValue(const std::string& key, const ArrayHandlers* handlers) {
+        if (handlers != nullptr) {
+            const auto iter = handlers->find(key);
+            char c;
+            if (iter != handlers->end() && NextNonSpace(c)) {
+                if (c == '[') {
+                    std::pmr::memory_resource* const document_resource = resource_;
+                    resource_ = std::pmr::get_default_resource();
+                    LoadArrayItems([&iter](Node&& node) {
+                        iter->second(std::move(node));
+                    });
+                    resource_ = document_resource;
+                    return Node(Array(resource_));
                 }
-                dict.emplace(std::move(key), LoadNode(input));
-            } else {
-                throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                --pos_;
             }
-        } else if (c != ',') {
-            throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
         }
+        return LoadNode();
     }
-    if (!input) {
-        throw ParsingError("Dictionary parsing error"s);
+
+    Node LoadDict(const ArrayHandlers* handlers = nullptr) {
+        // пары копятся в общем для всех уровней стеке разбора, словарь получает их
+        // одним выделением памяти и упорядочивается один раз в конце
+        const size_t items_begin = dict_items_.size();
+        std::unordered_set<std::string> large_dict_keys;
+
+        char c;
+        bool closed = false;
+        while (NextNonSpace(c)) {
+            if (c == '}') {
+                closed = true;
+                break;
+            }
+            if (c == '"') {
+                std::string key = std::move(LoadString().AsString());
+                if (NextNonSpace(c) && c == ':') {
+                    if (HasKey(items_begin, large_dict_keys, key)) {
+                        throw ParsingError("Duplicate key '"s + key + "' have been found");
+                    }
+                    Node value = LoadRootValue(key, handlers);
+                    dict_items_.emplace_back(std::move(key), std::move(value));
+                } else {
+                    throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                }
+            } else if (c != ',') {
+                throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+            }
+        }
+        if (!closed) {
+            throw ParsingError("Dictionary parsing error"s);
+        }
+        Dict::container_type items(resource_);
+        items.reserve(dict_items_.size() - items_begin);
+        std::move(dict_items_.begin() + items_begin, dict_items_.end(), std::back_inserter(items));
+        dict_items_.resize(items_begin);
+        return Node(Dict::FromUnsorted(std::move(items)));
     }
-    return Node(std::move(dict));
-}
 
-Node LoadString(std::istream& input) {
-    auto it = std::istreambuf_iterator<char>(input);
-    auto end = std::istreambuf_iterator<char>();
-    std::string s;
-    while (true) {
-        if (it == end) {
-            throw ParsingError("String parsing error");
+    // в маленьком словаре ключ ищется перебором, в большом - по множеству уже прочитанных ключей
+    bool HasKey(size_t items_begin, std::unordered_set<std::string>& large_dict_keys, const std::string& key) const {
+        static constexpr size_t LINEAR_SEARCH_LIMIT = 64;
+        const auto begin = dict_items_.begin() + items_begin;
+        if (dict_items_.end() - begin < static_cast<std::ptrdiff_t>(LINEAR_SEARCH_LIMIT)) {
+            return std::any_of(begin, dict_items_.end(), [&key](const Dict::value_type& item) {
+                return item.first == key;
+            });
         }
-        const char ch = *it;
-        if (ch == '"') {
-            ++it;
-            break;
-        } else if (ch == '\\') {
-            ++it;
-            if (it == end) {
+        if (large_dict_keys.empty()) {
+            for (auto iter = begin; iter != dict_items_.end(); ++iter) {
+                large_dict_keys.insert(iter->first);
+            }
+        }
+        return !large_dict_keys.insert(key).second;
+    }
+
+    Node LoadString() {
+        std::string s;
+        while (true) {
+            const char* special = FindStringSpecial(pos_, end_);
+            s.append(pos_, special);
+            pos_ = special;
+            if (pos_ == end_) {
                 throw ParsingError("String parsing error");
             }
-            const char escaped_char = *(it);
-            switch (escaped_char) {
-                case 'n':
-                    s.push_back('\n');
-                    break;
-                case 't':
-                    s.push_back('\t');
-                    break;
-                case 'r':
-                    s.push_back('\r');
-                    break;
-                case '"':
-                    s.push_back('"');
-                    break;
-                case '\\':
-                    s.push_back('\\');
-                    break;
-                default:
-                    throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+
+            const char ch = *pos_++;
+            if (ch == '"') {
+                break;
+            } else if (ch == '\\') {
+                if (pos_ == end_) {
+                    throw ParsingError("String parsing error");
+                }
+                const char escaped_char = *pos_++;
+                switch (escaped_char) {
+                    case 'n':
+                        s.push_back('\n');
+                        break;
+                    case 't':
+                        s.push_back('\t');
+                        break;
+                    case 'r':
+                        s.push_back('\r');
+                        break;
+                    case '"':
+                        s.push_back('"');
+                        break;
+                    case '\\':
+                        s.push_back('\\');
+                        break;
+                    default:
+                        throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+                }
+            } else {
+                throw ParsingError("Unexpected end of line"s);
             }
-        } else if (ch == '\n' || ch == '\r') {
-            throw ParsingError("Unexpected end of line"s);
-        } else {
-            s.push_back(ch);
         }
-        ++it;
+
+        return Node(std::move(s));
     }
 
-    return Node(std::move(s));
-}
+    Node LoadBool() {
+        const auto s = LoadLiteral();
+        if (s == "true"sv) {
+            return Node{true};
+        } else if (s == "false"sv) {
+            return Node{false};
+        } else {
+            throw ParsingError("Failed to parse '"s + std::string(s) + "' as bool"s);
+        }
+    }
 
-Node LoadBool(std::istream& input) {
-    const auto s = LoadLiteral(input);
-    if (s == "true"sv) {
-        return Node{true};
-    } else if (s == "false"sv) {
-        return Node{false};
-    } else {
-        throw ParsingError("Failed to parse '"s + s + "' as bool"s);
+    Node LoadNull() {
+        if (auto literal = LoadLiteral(); literal == "null"sv) {
+            return Node{nullptr};
+        } else {
+            throw ParsingError("Failed to parse '"s + std::string(literal) + "' as null"s);
+        }
     }
-}
 
-Node LoadNull(std::istream& input) {
-    if (auto literal = LoadLiteral(input); literal == "null"sv) {
-        return Node{nullptr};
-    } else {
-        throw ParsingError("Failed to parse '"s + literal + "' as null"s);
+    void ReadDigits() {
+        if (!IsDigit(static_cast<char>(Peek()))) {
+            throw ParsingError("A digit is expected"s);
+        }
+        while (pos_ != end_ && IsDigit(*pos_)) {
+            ++pos_;
+        }
     }
-}
 
-Node LoadNumber(std::istream& input) {
-    std::string parsed_num;
+    Node LoadNumber() {
+        const char* begin = pos_;
 
-    // Считывает в parsed_num очередной символ из input
-    auto read_char = [&parsed_num, &input] {
-        parsed_num += static_cast<char>(input.get());
-        if (!input) {
-            throw ParsingError("Failed to read number from stream"s);
+        if (Peek() == '-') {
+            ++pos_;
+        }
+        // Парсим целую часть числа
+        if (Peek() == '0') {
+            ++pos_;
+            // После 0 в JSON не могут идти другие цифры
+        } else {
+            ReadDigits();
         }
-    };
 
-    // Считывает одну или более цифр в parsed_num из input
-    auto read_digits = [&input, read_char] {
-        if (!std::isdigit(input.peek())) {
-            throw ParsingError("A digit is expected"s);
+        bool is_int = true;
+        // Парсим дробную часть числа
+        if (Peek() == '.') {
+            ++pos_;
+            ReadDigits();
+            is_int = false;
         }
-        while (std::isdigit(input.peek())) {
-            read_char();
+
+        // Парсим экспоненциальную часть числа
+        if (int ch = Peek(); ch == 'e' || ch == 'E') {
+            ++pos_;
+            if (ch = Peek(); ch == '+' || ch == '-') {
+                ++pos_;
+            }
+            ReadDigits();
+            is_int = false;
         }
-    };
 
-    if (input.peek() == '-') {
-        read_char();
+        if (is_int) {
+            // Сначала пробуем преобразовать строку в int,
+            // при переполнении код ниже преобразует ее в double
+            int int_value = 0;
+            if (const auto [ptr, ec] = std::from_chars(begin, pos_, int_value); ec == std::errc{} && ptr == pos_) {
+                return int_value;
+            }
+        }
+
+        double double_value = 0;
+        if (const auto [ptr, ec] = std::from_chars(begin, pos_, double_value); ec == std::errc{} && ptr == pos_) {
+            return double_value;
+        }
+        throw ParsingError("Failed to convert "s + std::string(begin, pos_) + " to number"s);
     }
-    // Парсим целую часть числа
-    if (input.peek() == '0') {
-        read_char();
-        // После 0 в JSON не могут идти другие цифры
-    } else {
-        read_digits();
+};
+
+}  // namespace
+
+// Буферизованный вывод: символы копятся в буфере и уходят в поток крупными блоками.
+// Числа форматируются std::to_chars так же, как operator<< потока с его точностью
+class Writer {
+public:
+    explicit Writer(std::ostream& out)
+        : out_(out)
+        , precision_(static_cast<int>(out.precision())) {
     }
 
-    bool is_int = true;
-    // Парсим дробную часть числа
-    if (input.peek() == '.') {
-        read_char();
-        read_digits();
-        is_int = false;
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    ~Writer() {
+        Flush();
     }
 
-    // Парсим экспоненциальную часть числа
-    if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-        read_char();
-        if (ch = input.peek(); ch == '+' || ch == '-') {
-            read_char();
+    void Put(char c) {
+        if (size_ == BUFFER_SIZE) {
+            Flush();
         }
-        read_digits();
-        is_int = false;
+        buffer_[size_++] = c;
     }
 
-    try {
-        if (is_int) {
-            // Сначала пробуем преобразовать строку в int
-            try {
-                return std::stoi(parsed_num);
-            } catch (...) {
-                // В случае неудачи, например, при переполнении
-                // код ниже попробует преобразовать строку в double
+    void Write(std::string_view text) {
+        if (text.size() > BUFFER_SIZE - size_) {
+            Flush();
+            if (text.size() > BUFFER_SIZE) {
+                out_.write(text.data(), static_cast<std::streamsize>(text.size()));
+                return;
             }
         }
-        return std::stod(parsed_num);
-    } catch (...) {
-        throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
-    }
-}
-
-Node LoadNode(std::istream& input) {
-    char c;
-    if (!(input >> c)) {
-        throw ParsingError("Unexpected EOF"s);
-    }
-    switch (c) {
-        case '[':
-            return LoadArray(input);
-        case '{':
-            return LoadDict(input);
-        case '"':
-            return LoadString(input);
-        case 't':
-            // Атрибут [[fallthrough]] (провалиться) ничего не делает, и является
-            // подсказкой компилятору и человеку, что здесь программист явно задумывал
-            // разрешить переход к инструкции следующей ветки case, а не случайно забыл
-            // написать break, return или throw.
-            // В данном случае, встретив t или f, переходим к попытке парсинга
-            // литералов true либо false
-            [[fallthrough]];
-        case 'f':
-            input.putback(c);
-            return LoadBool(input);
-        case 'n':
-            input.putback(c);
-            return LoadNull(input);
-        default:
-            input.putback(c);
-            return LoadNumber(input);
+        std::memcpy(buffer_ + size_, text.data(), text.size());
+        size_ += text.size();
+    }
+
+    void Fill(char c, size_t count) {
+        while (count != 0) {
+            if (size_ == BUFFER_SIZE) {
+                Flush();
+            }
+            const size_t part = std::min(count, BUFFER_SIZE - size_);
+            std::memset(buffer_ + size_, c, part);
+            size_ += part;
+            count -= part;
+        }
+    }
+
+    template <typename Number>
+    void WriteNumber(Number value) {
+        // хватает для int и для double в формате %g с любой разумной точностью
+        static constexpr size_t MAX_NUMBER_SIZE = 128;
+        if (BUFFER_SIZE - size_ < MAX_NUMBER_SIZE) {
+            Flush();
+        }
+        char* const begin = buffer_ + size_;
+        std::to_chars_result result;
+        if constexpr (std::is_floating_point_v<Number>) {
+            result = std::to_chars(begin, begin + MAX_NUMBER_SIZE, value, std::chars_format::general, precision_);
+        } else {
+            result = std::to_chars(begin, begin + MAX_NUMBER_SIZE, value);
+        }
+        size_ += static_cast<size_t>(result.ptr - begin);
+    }
+
+    void Flush() {
+        if (size_ != 0) {
+            out_.write(buffer_, static_cast<std::streamsize>(size_));
+            size_ = 0;
+        }
     }
-}
+
+private:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    std::ostream& out_;
+    int precision_;
+    size_t size_ = 0;
+    char buffer_[BUFFER_SIZE];
+};
+
+namespace {
 
 struct PrintContext {
-    std::ostream& out;
+    Writer& out;
     int indent_step = 4;
     int indent = 0;
+    // компактный вывод в одну строку, без переводов строк и отступов
+    bool compact = false;
 
     void PrintIndent() const {
-        for (int i = 0; i < indent; ++i) {
-            out.put(' ');
+        if (compact) {
+            return;
+        }
+        out.Fill(' ', static_cast<size_t>(indent));
+    }
+
+    void PrintLineBreak() const {
+        if (!compact) {
+            out.Put('\n');
         }
     }
 
     PrintContext Indented() const {
-        return {out, indent_step, indent_step + indent};
+        return {out, indent_step, indent_step + indent, compact};
     }
 };
 
@@ -242,31 +513,36 @@ void PrintNode(const Node& value, const PrintContext& ctx);
 
 template <typename Value>
 void PrintValue(const Value& value, const PrintContext& ctx) {
-    ctx.out << value;
+    ctx.out.WriteNumber(value);
 }
 
-void PrintString(const std::string& value, std::ostream& out) {
-    out.put('"');
-    for (const char c : value) {
-        switch (c) {
+// Участки без спецсимволов копируются целиком, экранируются только " \ и переводы строк
+void PrintString(std::string_view value, Writer& out) {
+    out.Put('"');
+    const char* pos = value.data();
+    const char* const end = pos + value.size();
+    while (pos != end) {
+        const char* special = FindStringSpecial(pos, end);
+        out.Write({pos, static_cast<size_t>(special - pos)});
+        if (special == end) {
+            break;
+        }
+        switch (*special) {
             case '\r':
-                out << "\\r"sv;
+                out.Write("\\r"sv);
                 break;
             case '\n':
-                out << "\\n"sv;
+                out.Write("\\n"sv);
                 break;
-            case '"':
-                // Символы " и \ выводятся как \" или \\, соответственно
-                [[fallthrough]];
-            case '\\':
-                out.put('\\');
-                [[fallthrough]];
             default:
-                out.put(c);
+                // Символы " и \ выводятся как \" или \\, соответственно
+                out.Put('\\');
+                out.Put(*special);
                 break;
         }
+        pos = special + 1;
     }
-    out.put('"');
+    out.Put('"');
 }
 
 template <>
@@ -276,7 +552,7 @@ void PrintValue<std::string>(const std::string& value, const PrintContext& ctx)
 
 template <>
 void PrintValue<std::nullptr_t>(const std::nullptr_t&, const PrintContext& ctx) {
-    ctx.out << "null"sv;
+    ctx.out.Write("null"sv);
 }
 
 // В специализаци шаблона PrintValue для типа bool параметр value передаётся
@@ -285,49 +561,53 @@ void PrintValue<std::nullptr_t>(const std::nullptr_t&, const PrintContext& ctx)
 // void PrintValue(bool value, const PrintContext& ctx);
 template <>
 void PrintValue<bool>(const bool& value, const PrintContext& ctx) {
-    ctx.out << (value ? "true"sv : "false"sv);
+    ctx.out.Write(value ? "true"sv : "false"sv);
 }
 
 template <>
 void PrintValue<Array>(const Array& nodes, const PrintContext& ctx) {
-    std::ostream& out = ctx.out;
-    out << "[\n"sv;
+    Writer& out = ctx.out;
+    out.Put('[');
+    ctx.PrintLineBreak();
     bool first = true;
     auto inner_ctx = ctx.Indented();
     for (const Node& node : nodes) {
         if (first) {
             first = false;
         } else {
-            out << ",\n"sv;
+            out.Put(',');
+            ctx.PrintLineBreak();
         }
         inner_ctx.PrintIndent();
         PrintNode(node, inner_ctx);
     }
-    out.put('\n');
+    ctx.PrintLineBreak();
     ctx.PrintIndent();
-    out.put(']');
+    out.Put(']');
 }
 
 template <>
 void PrintValue<Dict>(const Dict& nodes, const PrintContext& ctx) {
-    std::ostream& out = ctx.out;
-    out << "{\n"sv;
+    Writer& out = ctx.out;
+    out.Put('{');
+    ctx.PrintLineBreak();
     bool first = true;
     auto inner_ctx = ctx.Indented();
     for (const auto& [key, node] : nodes) {
         if (first) {
             first = false;
         } else {
-            out << ",\n"sv;
+            out.Put(',');
+            ctx.PrintLineBreak();
         }
         inner_ctx.PrintIndent();
         PrintString(key, ctx.out);
-        out << ": "sv;
+        out.Write(ctx.compact ? ":"sv : ": "sv);
         PrintNode(node, inner_ctx);
     }
-    out.put('\n');
+    ctx.PrintLineBreak();
     ctx.PrintIndent();
-    out.put('}');
+    out.Put('}');
 }
 
 void PrintNode(const Node& node, const PrintContext& ctx) {
@@ -338,14 +618,232 @@ void PrintNode(const Node& node, const PrintContext& ctx) {
         node.GetValue());
 }
 
+std::string ReadAll(std::istream& input) {
+    // поток читается крупными блоками, а не посимвольно
+    static constexpr size_t READ_BLOCK_SIZE = 1 << 16;
+
+    std::string buffer;
+    size_t size = 0;
+    do {
+        buffer.resize(size + READ_BLOCK_SIZE);
+        input.read(buffer.data() + size, READ_BLOCK_SIZE);
+        size += static_cast<size_t>(input.gcount());
+    } while (input);
+    buffer.resize(size);
+
+    return buffer;
+}
+
+// Первый блок арены соразмерен входу, следующие монотонная арена наращивает сама
+std::shared_ptr<std::pmr::memory_resource> CreateArena(size_t input_size) {
+    static constexpr size_t MIN_ARENA_BLOCK = 4 * 1024;
+    return std::make_shared<std::pmr::monotonic_buffer_resource>(std::max(input_size, MIN_ARENA_BLOCK));
+}
+
 }  // namespace
 
-Document Load(std::istream& input) {
-    return Document{LoadNode(input)};
+Dict::Dict(std::initializer_list<value_type> items)
+    : items_(items) {
+    // как у std::map: из одинаковых ключей остается первый
+    std::stable_sort(items_.begin(), items_.end(), [](const value_type& lhs, const value_type& rhs) {
+        return lhs.first < rhs.first;
+    });
+    items_.erase(std::unique(items_.begin(), items_.end(), [](const value_type& lhs, const value_type& rhs) {
+                     return lhs.first == rhs.first;
+                 }),
+                 items_.end());
+}
+
+Dict Dict::FromUnsorted(container_type&& items) {
+    const auto key_less = [](const value_type& lhs, const value_type& rhs) {
+        return lhs.first < rhs.first;
+    };
+    if (!std::is_sorted(items.begin(), items.end(), key_less)) {
+        std::sort(items.begin(), items.end(), key_less);
+    }
+    // перемещающий конструктор сохраняет ресурс памяти items, присваивание бы его не сохранило
+    return Dict(std::move(items));
+}
+
+Dict::Dict(container_type&& items)
+    : items_(std::move(items)) {
+}
+
+Document Load(std::string_view input, Allocation allocation) {
+    if (allocation == Allocation::ARENA) {
+        auto arena = CreateArena(input.size());
+        Node root = Parser(input.data(), input.data() + input.size(), arena.get()).LoadNode();
+        return Document{std::move(root), std::move(arena)};
+    }
+    return Document{Parser(input.data(), input.data() + input.size(), std::pmr::get_default_resource()).LoadNode()};
+}
+
+Document Load(std::istream& input, Allocation allocation) {
+    return Load(std::string_view(ReadAll(input)), allocation);
+}
+
+Document LoadStreaming(std::string_view input, const ArrayHandlers& handlers, Allocation allocation) {
+    if (allocation == Allocation::ARENA) {
+        auto arena = CreateArena(input.size());
+        Node root = Parser(input.data(), input.data() + input.size(), arena.get()).LoadRoot(handlers);
+        return Document{std::move(root), std::move(arena)};
+    }
+    return Document{Parser(input.data(), input.data() + input.size(), std::pmr::get_default_resource()).LoadRoot(handlers)};
+}
+
+Document LoadStreaming(std::istream& input, const ArrayHandlers& handlers, Allocation allocation) {
+    return LoadStreaming(std::string_view(ReadAll(input)), handlers, allocation);
+}
+
+StreamWriter::StreamWriter(std::ostream& output, bool compact, int depth)
+    : writer_(std::make_unique<Writer>(output))
+    , compact_(compact)
+    , depth_(depth) {
+}
+
+StreamWriter::~StreamWriter() = default;
+
+StreamWriter& StreamWriter::StartArray() {
+    BeginValue();
+    writer_->Put('[');
+    PrintLineBreak();
+    first_in_container_.push_back(true);
+    return *this;
+}
+
+StreamWriter& StreamWriter::EndArray() {
+    EndContainer(']');
+    return *this;
+}
+
+StreamWriter& StreamWriter::StartDict() {
+    BeginValue();
+    writer_->Put('{');
+    PrintLineBreak();
+    first_in_container_.push_back(true);
+    return *this;
+}
+
+StreamWriter& StreamWriter::EndDict() {
+    EndContainer('}');
+    return *this;
+}
+
+StreamWriter& StreamWriter::Key(std::string_view key) {
+    BeginItem();
+    PrintString(key, *writer_);
+    writer_->Write(compact_ ? ":"sv : ": "sv);
+    after_key_ = true;
+    return *this;
+}
+
+StreamWriter& StreamWriter::Value(std::string_view value) {
+    BeginValue();
+    PrintString(value, *writer_);
+    return *this;
+}
+
+StreamWriter& StreamWriter::Value(const char* value) {
+    return Value(std::string_view(value));
+}
+
+StreamWriter& StreamWriter::Value(const std::string& value) {
+    return Value(std::string_view(value));
+}
+
+StreamWriter& StreamWriter::Value(int value) {
+    BeginValue();
+    writer_->WriteNumber(value);
+    return *this;
+}
+
+StreamWriter& StreamWriter::Value(double value) {
+    BeginValue();
+    writer_->WriteNumber(value);
+    return *this;
+}
+
+StreamWriter& StreamWriter::Value(bool value) {
+    BeginValue();
+    writer_->Write(value ? "true"sv : "false"sv);
+    return *this;
+}
+
+StreamWriter& StreamWriter::Value(std::nullptr_t) {
+    BeginValue();
+    writer_->Write("null"sv);
+    return *this;
+}
+
+StreamWriter& StreamWriter::Value(const Node& value) {
+    BeginValue();
+    PrintNode(value, PrintContext{*writer_, INDENT_STEP, GetIndent(), compact_});
+    return *this;
+}
+
+StreamWriter& StreamWriter::RawValue(std::string_view text) {
+    BeginValue();
+    writer_->Write(text);
+    return *this;
+}
+
+void StreamWriter::Flush() {
+    writer_->Flush();
+}
+
+int StreamWriter::GetIndent() const {
+    return INDENT_STEP * (depth_ + static_cast<int>(first_in_container_.size()));
+}
+
+void StreamWriter::PrintLineBreak() {
+    if (!compact_) {
+        writer_->Put('\n');
+    }
+}
+
+void StreamWriter::PrintIndent() {
+    if (!compact_) {
+        writer_->Fill(' ', static_cast<size_t>(GetIndent()));
+    }
+}
+
+void StreamWriter::BeginItem() {
+    if (first_in_container_.empty()) {
+        return;
+    }
+    if (first_in_container_.back()) {
+        first_in_container_.back() = false;
+    } else {
+        writer_->Put(',');
+        PrintLineBreak();
+    }
+    PrintIndent();
+}
+
+void StreamWriter::BeginValue() {
+    // значение словаря пишется сразу за ключом, элемент массива - с новой строки
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    BeginItem();
+}
+
+void StreamWriter::EndContainer(char close) {
+    first_in_container_.pop_back();
+    PrintLineBreak();
+    PrintIndent();
+    writer_->Put(close);
 }
 
 void Print(const Document& doc, std::ostream& output) {
-    PrintNode(doc.GetRoot(), PrintContext{output});
+    Writer writer(output);
+    PrintNode(doc.GetRoot(), PrintContext{writer});
+}
+
+void PrintCompact(const Document& doc, std::ostream& output) {
+    Writer writer(output);
+    PrintNode(doc.GetRoot(), PrintContext{writer, 0, 0, true});
 }
 
 }  // namespace json
\ No newline at end of file
@@ -1,16 +1,77 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <variant>
 #include <vector>
 
 namespace json {
 
 class Node;
-using Dict = std::map<std::string, Node>;
-using Array = std::vector<Node>;
+// массивы и словари размещаются через std::pmr, чтобы дерево документа могло жить в арене
+using Array = std::pmr::vector<Node>;
+
+// Словарь узлов: пары ключ-значение в векторе, упорядоченном по ключу. Объекты JSON
+// в запросах маленькие, поэтому поиск делением пополам по непрерывному массиву быстрее
+// дерева, а на словарь приходится одно выделение памяти вместо узла на каждый ключ.
+// Короткие ключи хранятся внутри std::string без выделения памяти.
+// Интерфейс и порядок обхода совпадают с std::map<std::string, Node>
+class Dict {
+public:
+    using key_type = std::string;
+    using mapped_type = Node;
+    using value_type = std::pair<std::string, Node>;
+    using container_type = std::pmr::vector<value_type>;
+    using iterator = container_type::iterator;
+    using const_iterator = container_type::const_iterator;
+
+    Dict() = default;
+    Dict(std::initializer_list<value_type> items);
+
+    // items в произвольном порядке, ключи должны быть уникальны
+    static Dict FromUnsorted(container_type&& items);
+
+    iterator begin() { return items_.begin(); }
+    iterator end() { return items_.end(); }
+    const_iterator begin() const { return items_.begin(); }
+    const_iterator end() const { return items_.end(); }
+
+    size_t size() const { return items_.size(); }
+    bool empty() const { return items_.empty(); }
+
+    iterator find(std::string_view key);
+    const_iterator find(std::string_view key) const;
+    size_t count(std::string_view key) const;
+
+    Node& at(std::string_view key);
+    const Node& at(std::string_view key) const;
+    Node& operator[](std::string_view key);
+
+    // при существующем ключе значение не заменяется, как в std::map
+    std::pair<iterator, bool> insert(value_type&& value);
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(std::string key, Args&&... args);
+    std::pair<iterator, bool> emplace(std::string key, Node value);
+
+    bool operator==(const Dict& rhs) const;
+
+private:
+    container_type items_;
+
+    explicit Dict(container_type&& items);
+
+    iterator LowerBound(std::string_view key);
+    const_iterator LowerBound(std::string_view key) const;
+};
 
 class ParsingError : public std::runtime_error {
 public:
@@ -142,17 +203,96 @@ inline bool operator!=(const Node& lhs, const Node& rhs) {
     return !(lhs == rhs);
 }
 
+inline Dict::iterator Dict::LowerBound(std::string_view key) {
+    return std::lower_bound(items_.begin(), items_.end(), key, [](const value_type& item, std::string_view key) {
+        return item.first < key;
+    });
+}
+
+inline Dict::const_iterator Dict::LowerBound(std::string_view key) const {
+    return std::lower_bound(items_.begin(), items_.end(), key, [](const value_type& item, std::string_view key) {
+        return item.first < key;
+    });
+}
+
+inline Dict::iterator Dict::find(std::string_view key) {
+    const auto iter = LowerBound(key);
+    return iter != items_.end() && iter->first == key ? iter : items_.end();
+}
+
+inline Dict::const_iterator Dict::find(std::string_view key) const {
+    const auto iter = LowerBound(key);
+    return iter != items_.end() && iter->first == key ? iter : items_.end();
+}
+
+inline size_t Dict::count(std::string_view key) const {
+    return find(key) != items_.end() ? 1 : 0;
+}
+
+inline Node& Dict::at(std::string_view key) {
+    using namespace std::literals;
+    const auto iter = find(key);
+    if (iter == items_.end()) {
+        throw std::out_of_range("Dict::at: key not found"s);
+    }
+    return iter->second;
+}
+
+inline const Node& Dict::at(std::string_view key) const {
+    using namespace std::literals;
+    const auto iter = find(key);
+    if (iter == items_.end()) {
+        throw std::out_of_range("Dict::at: key not found"s);
+    }
+    return iter->second;
+}
+
+inline Node& Dict::operator[](std::string_view key) {
+    return try_emplace(std::string(key)).first->second;
+}
+
+template <typename... Args>
+std::pair<Dict::iterator, bool> Dict::try_emplace(std::string key, Args&&... args) {
+    const auto iter = LowerBound(key);
+    if (iter != items_.end() && iter->first == key) {
+        return {iter, false};
+    }
+    return {items_.emplace(iter, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                           std::forward_as_tuple(std::forward<Args>(args)...)),
+            true};
+}
+
+inline std::pair<Dict::iterator, bool> Dict::insert(value_type&& value) {
+    return try_emplace(std::move(value.first), std::move(value.second));
+}
+
+inline std::pair<Dict::iterator, bool> Dict::emplace(std::string key, Node value) {
+    return try_emplace(std::move(key), std::move(value));
+}
+
+inline bool Dict::operator==(const Dict& rhs) const {
+    return items_ == rhs.items_;
+}
+
 class Document {
 public:
     explicit Document(Node root)
         : root_(std::move(root)) {
     }
 
+    // узлы root размещены в arena, документ продлевает ее жизнь на время жизни дерева
+    Document(Node root, std::shared_ptr<std::pmr::memory_resource> arena)
+        : arena_(std::move(arena))
+        , root_(std::move(root)) {
+    }
+
     const Node& GetRoot() const {
         return root_;
     }
 
 private:
+    // объявлена раньше root_, чтобы дерево разрушалось до освобождения арены
+    std::shared_ptr<std::pmr::memory_resource> arena_;
     Node root_;
 };
 
@@ -164,8 +304,87 @@ inline bool operator!=(const Document& lhs, const Document& rhs) {
     return !(lhs == rhs);
 }
 
-Document Load(std::istream& input);
+// HEAP - каждый массив и словарь выделяется в куче отдельно. ARENA - все массивы и словари
+// документа берутся из монотонной арены, которой владеет документ: построение и разрушение
+// дерева обходятся несколькими крупными выделениями. Строки остаются std::string и
+// выделяют память, только если не помещаются во встроенный буфер
+enum class Allocation {
+    HEAP,
+    ARENA
+};
+
+// Документ разбирается из непрерывного буфера, поток читается в буфер целиком
+Document Load(std::string_view input, Allocation allocation = Allocation::HEAP);
+Document Load(std::istream& input, Allocation allocation = Allocation::HEAP);
+
+// Потоковый разбор: элементы массивов корневого словаря с ключами из handlers передаются
+// обработчику по одному сразу после разбора и не накапливаются - в документе по этим ключам
+// остаются пустые массивы. Остальное разбирается как в Load, элементы для обработчиков
+// всегда выделяются в куче, так как могут жить дольше документа
+using ArrayElementHandler = std::function<void(Node&&)>;
+using ArrayHandlers = std::map<std::string, ArrayElementHandler, std::less<>>;
+
+Document LoadStreaming(std::string_view input, const ArrayHandlers& handlers, Allocation allocation = Allocation::HEAP);
+Document LoadStreaming(std::istream& input, const ArrayHandlers& handlers, Allocation allocation = Allocation::HEAP);
 
 void Print(const Document& doc, std::ostream& output);
+// вывод в одну строку без пробельных символов
+void PrintCompact(const Document& doc, std::ostream& output);
+
+class Writer;
+
+// Запись JSON в поток по частям, без построения дерева узлов. Текст совпадает с Print
+// (с PrintCompact при compact), если ключи каждого словаря пишутся по возрастанию, как
+// их обходит Print. depth - уровень вложенности, на котором стоит записываемое значение:
+// так значение можно записать отдельно и затем вставить через RawValue
+class StreamWriter {
+public:
+    explicit StreamWriter(std::ostream& output, bool compact = false, int depth = 0);
+    ~StreamWriter();
+
+    StreamWriter(const StreamWriter&) = delete;
+    StreamWriter& operator=(const StreamWriter&) = delete;
+
+    StreamWriter& StartArray();
+    StreamWriter& EndArray();
+    StreamWriter& StartDict();
+    StreamWriter& EndDict();
+    StreamWriter& Key(std::string_view key);
+
+    StreamWriter& Value(std::string_view value);
+    StreamWriter& Value(const char* value);
+    StreamWriter& Value(const std::string& value);
+    StreamWriter& Value(int value);
+    StreamWriter& Value(double value);
+    StreamWriter& Value(bool value);
+    StreamWriter& Value(std::nullptr_t);
+    StreamWriter& Value(const Node& value);
+    // готовый текст значения, записанный другим StreamWriter
+    StreamWriter& RawValue(std::string_view text);
+
+    // остаток буфера уходит в поток и при разрушении
+    void Flush();
+
+    bool IsCompact() const {
+        return compact_;
+    }
+
+private:
+    static constexpr int INDENT_STEP = 4;
+
+    std::unique_ptr<Writer> writer_;
+    bool compact_;
+    int depth_;
+    // для каждого открытого контейнера: не было ли еще в нем элементов
+    std::vector<bool> first_in_container_;
+    bool after_key_ = false;
+
+    int GetIndent() const;
+    void PrintLineBreak();
+    void PrintIndent();
+    void BeginItem();
+    void BeginValue();
+    void EndContainer(char close);
+};
 
 }  // namespace json
\ No newline at end of file
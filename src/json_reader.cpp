@@ -11,8 +11,12 @@ namespace NS_TransportCatalogue::Interfaces
 {
     void JsonReader::ReadInput(std::istream& instream)
     {
-        json_data_ = std::make_unique<json::Document>(json::Load(instream));
-        
+        // элементы base_requests передаются в базу по мере чтения и не хранятся в документе
+        json::ArrayHandlers handlers;
+        handlers.emplace("base_requests", [this](json::Node&& value) { ParseStopOrBus(value.AsDict()); });
+        json_data_ = std::make_unique<json::Document>(json::LoadStreaming(instream, handlers, json::Allocation::ARENA));
+        RequestHandler::FinishUpload();
+
         ReadContent();
     }
 
@@ -104,8 +108,38 @@ namespace NS_TransportCatalogue::Interfaces
         {
             throw std::invalid_argument("router settings error: bus speed cannot be 0"); 
         }
+        if (router_settings_.mode == TransportCatalogue_Router::RouterMode::RAPTOR)
+        {
+            raptor_router_ = std::make_unique<TransportCatalogue_Router::RaptorRouter>(db_, router_settings_);
+            return;
+        }
         graph_builder_ = std::make_unique<TransportCatalogue_Router::GraphBuilder>(db_, router_settings_);
-        router_ = std::make_unique<graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>>(graph_builder_->GetGraphRef());
+        CreateRouterFromGraph();
+    }
+
+    void JsonReader::CreateRouterFromGraph()
+    {
+        if (router_settings_.mode == TransportCatalogue_Router::RouterMode::DIJKSTRA)
+        {
+            router_ = std::make_unique<graph::DijkstraRouter<TransportCatalogue_Router::GraphBuilder::RouterWeight>>(graph_builder_->GetGraphRef());
+        }
+        else if (router_settings_.mode == TransportCatalogue_Router::RouterMode::CONTRACTION_HIERARCHIES)
+        {
+            router_ = std::make_unique<CHRouter>(graph_builder_->GetGraphRef());
+        }
+        else
+        {
+            router_ = std::make_unique<Router>(graph_builder_->GetGraphRef(), GetPool());
+        }
+    }
+
+    thread_pool::ThreadPool* JsonReader::GetPool()
+    {
+        if (pool_ == nullptr)
+        {
+            pool_ = std::make_unique<thread_pool::ThreadPool>();
+        }
+        return pool_.get();
     }
 
     const MapRenderer::RenderSetting& JsonReader::GetRenderSettings() const
@@ -113,63 +147,119 @@ namespace NS_TransportCatalogue::Interfaces
         return render_settings_;
     }
 
-    json::Node JsonReader::ReturnStop(const json::Dict& value) const
+    // Ответы пишутся прямо в поток, ключи - в порядке возрастания, как их выводит json::Print.
+    // Имена берутся из хранилищ каталога и маршрутизатора без копирования
+    void JsonReader::WriteNotFound(json::StreamWriter& out, const json::Dict& value) const
+    {
+        out.StartDict()
+            .Key("error_message").Value("not found")
+            .Key("request_id").Value(value.at("id").AsInt())
+            .EndDict();
+    }
+
+    void JsonReader::WriteStop(json::StreamWriter& out, const json::Dict& value) const
     {
-        json::Builder out;
         auto stop_answer = db_.GetStop(value.at("name").AsString());
-        if (stop_answer)
+        if (!stop_answer)
         {
-            json::Array buses_vec;
-            buses_vec.reserve(stop_answer->buses_throw_stop.size());
-            for (auto& bus : stop_answer->buses_throw_stop)
-            {
-                buses_vec.emplace_back(json::Node{std::string{bus}});
-            }
-
-            return out.StartDict().Key("buses"s).Value(std::move(buses_vec))
-                                    .Key("request_id"s).Value(value.at("id").AsInt())
-                                    .EndDict().Build();
+            WriteNotFound(out, value);
+            return;
         }
-        else
+
+        out.StartDict().Key("buses").StartArray();
+        for (const auto bus : stop_answer->buses_throw_stop)
         {
-            return out.StartDict().Key("request_id"s).Value(value.at("id").AsInt()).Key("error_message"s).Value("not found"s).EndDict().Build();
+            out.Value(bus);
         }
+        out.EndArray()
+            .Key("request_id").Value(value.at("id").AsInt())
+            .EndDict();
     }
 
-    json::Node JsonReader::ReturnBus(const json::Dict& value) const
+    void JsonReader::WriteBus(json::StreamWriter& out, const json::Dict& value) const
     {
-        json::Builder out;
-        auto bus_answer = db_.GetBus(value.at("name").AsString());
-        if (bus_answer)
+        auto bus_stats = db_.GetBusStats(value.at("name").AsString());
+        if (!bus_stats)
         {
-            int count_stops_all = bus_answer->route_type == domain::BussRootType::FORWARD ? (static_cast<int>(bus_answer->stops_vec.size()) * 2 - 1) : static_cast<int>(bus_answer->stops_vec.size());
-            
-            std::sort(bus_answer->stops_vec.begin(), bus_answer->stops_vec.end());
-            bus_answer->stops_vec.erase(std::unique(bus_answer->stops_vec.begin(), bus_answer->stops_vec.end()), bus_answer->stops_vec.end());
-            
-            int unique_stop_count = static_cast<int>(bus_answer->stops_vec.size());
+            WriteNotFound(out, value);
+            return;
+        }
+
+        out.StartDict()
+            .Key("curvature").Value(bus_stats->curvature)
+            .Key("request_id").Value(value.at("id").AsInt())
+            .Key("route_length").Value(static_cast<int>(bus_stats->route_length))
+            .Key("stop_count").Value(bus_stats->stop_count)
+            .Key("unique_stop_count").Value(bus_stats->unique_stop_count)
+            .EndDict();
+    }
+
+    void WriteWaitItem(json::StreamWriter& out, std::string_view stop_name, double time)
+    {
+        out.StartDict()
+            .Key("stop_name").Value(stop_name)
+            .Key("time").Value(time)
+            .Key("type").Value("Wait")
+            .EndDict();
+    }
+
+    void WriteBusItem(json::StreamWriter& out, std::string_view bus, int span_count, double time)
+    {
+        out.StartDict()
+            .Key("bus").Value(bus)
+            .Key("span_count").Value(span_count)
+            .Key("time").Value(time)
+            .Key("type").Value("Bus")
+            .EndDict();
+    }
 
-            return out.StartDict()
-                        .Key("curvature"s).Value(bus_answer->curvature)
-                        .Key("request_id"s).Value(value.at("id").AsInt())
-                        .Key("route_length"s).Value(static_cast<int>(bus_answer->route_length))
-                        .Key("stop_count"s).Value(count_stops_all)
-                        .Key("unique_stop_count"s).Value(unique_stop_count)
-                        .EndDict().Build();
+    void WriteLegItems(json::StreamWriter& out, const std::vector<TransportCatalogue_Router::RaptorRouter::Leg>& legs)
+    {
+        out.StartArray();
+        for (const auto& leg : legs)
+        {
+            WriteWaitItem(out, leg.board_stop->name, leg.wait_time);
+            WriteBusItem(out, leg.bus, leg.span_count, leg.ride_time);
         }
-        else
+        out.EndArray();
+    }
+
+    void JsonReader::WriteRouteItems(json::StreamWriter& out, const std::vector<graph::EdgeId>& edges) const
+    {
+        out.StartArray();
+        for (size_t item = 0; item < edges.size(); ++item)
         {
-            return out.StartDict().Key("request_id"s).Value(value.at("id").AsInt()).Key("error_message"s).Value("not found"s).EndDict().Build();
+            const TransportCatalogue_Router::GraphBuilder::EdgeInfo edge = graph_builder_->GetEdge(edges[item]);
+
+            if (edge.span_count == 0)
+            {
+                WriteWaitItem(out, edge.name, edge.weight);
+                continue;
+            }
+
+            // в линейной модели поездка - цепочка перегонов без ожидания между ними,
+            // в модели с пролетами за ребром автобуса всегда следует ожидание
+            int span_count = edge.span_count;
+            double time = edge.weight;
+            for (; item + 1 < edges.size() && graph_builder_->GetEdge(edges[item + 1]).span_count != 0; ++item)
+            {
+                const auto next = graph_builder_->GetEdge(edges[item + 1]);
+                span_count += next.span_count;
+                time += next.weight;
+            }
+            WriteBusItem(out, edge.name, span_count, time);
         }
+        out.EndArray();
     }
 
-    json::Node JsonReader::ReturnRoute(const json::Dict& value)
+    void JsonReader::WriteRoute(json::StreamWriter& out, const json::Dict& value) const
     {
-        if (graph_builder_ == nullptr || router_ == nullptr)
+        if (raptor_router_ != nullptr)
         {
-            CreateRouter();
+            WriteRaptorRoute(out, value);
+            return;
         }
-        json::Builder out;
+
         std::optional<unsigned int> stop_from = graph_builder_->GetBusID(value.at("from"s).AsString());
         std::optional<unsigned int> stop_to = graph_builder_->GetBusID(value.at("to"s).AsString());
 
@@ -178,41 +268,195 @@ namespace NS_TransportCatalogue::Interfaces
             auto route = router_->BuildRoute(*stop_from, *stop_to);
             if (route != std::nullopt)
             {
-                json::Array items;
-                for (size_t item : route->edges)
+                out.StartDict().Key("items");
+                WriteRouteItems(out, route->edges);
+                out.Key("request_id").Value(value.at("id").AsInt())
+                    .Key("total_time").Value(route->weight.weight)
+                    .EndDict();
+                return;
+            }
+        }
+
+        WriteNotFound(out, value);
+    }
+
+    void JsonReader::WriteRaptorRoute(json::StreamWriter& out, const json::Dict& value) const
+    {
+        const domain::Stop* stop_from = db_.GetStopPtr(value.at("from"s).AsString());
+        const domain::Stop* stop_to = db_.GetStopPtr(value.at("to"s).AsString());
+
+        if (stop_from != nullptr && stop_to != nullptr)
+        {
+            auto route = raptor_router_->BuildRoute(stop_from, stop_to);
+            if (route != std::nullopt)
+            {
+                out.StartDict().Key("items");
+                WriteLegItems(out, route->legs);
+                out.Key("request_id").Value(value.at("id").AsInt())
+                    .Key("total_time").Value(route->total_time)
+                    .EndDict();
+                return;
+            }
+        }
+
+        WriteNotFound(out, value);
+    }
+
+    // Матрица маршрутов между остановками from и to: вместо поиска на каждую пару маршрутизатор
+    // считает ее целиком, поиск на строку или по корзинам иерархии сжатия. Ячейка для неизвестной
+    // остановки или недостижимой пары - null. Маршруты (routes) выводятся только с with_items
+    void JsonReader::WriteRouteMatrix(json::StreamWriter& out, const json::Dict& value) const
+    {
+        const json::Array& from = value.at("from"s).AsArray();
+        const json::Array& to = value.at("to"s).AsArray();
+        const auto iter_items = value.find("with_items"s);
+        const bool with_items = iter_items != value.end() && iter_items->second.AsBool();
+
+        const size_t column_count = to.size();
+        std::vector<std::optional<double>> times(from.size() * column_count);
+        std::vector<std::optional<TransportCatalogue_Router::RaptorRouter::RouteInfo>> raptor_routes;
+        std::vector<std::optional<RouterBase::RouteInfo>> graph_routes;
+        if (raptor_router_ != nullptr)
+        {
+            raptor_routes.resize(with_items ? times.size() : 0);
+            std::vector<const domain::Stop*> targets;
+            std::vector<size_t> target_columns;
+            for (size_t column = 0; column < column_count; ++column)
+            {
+                const domain::Stop* stop = db_.GetStopPtr(to[column].AsString());
+                if (stop != nullptr)
+                {
+                    targets.push_back(stop);
+                    target_columns.push_back(column);
+                }
+            }
+
+            for (size_t row = 0; row < from.size(); ++row)
+            {
+                const domain::Stop* source = db_.GetStopPtr(from[row].AsString());
+                if (source == nullptr)
+                {
+                    continue;
+                }
+                auto routes = raptor_router_->BuildRoutes(source, targets, with_items);
+                for (size_t i = 0; i < routes.size(); ++i)
+                {
+                    const size_t cell = row * column_count + target_columns[i];
+                    if (routes[i] != std::nullopt)
+                    {
+                        times[cell] = routes[i]->total_time;
+                        if (with_items)
+                        {
+                            raptor_routes[cell] = std::move(routes[i]);
+                        }
+                    }
+                }
+            }
+        }
+        else
+        {
+            graph_routes.resize(with_items ? times.size() : 0);
+            std::vector<graph::VertexId> sources;
+            std::vector<size_t> source_rows;
+            for (size_t row = 0; row < from.size(); ++row)
+            {
+                const std::optional<unsigned int> vertex = graph_builder_->GetBusID(from[row].AsString());
+                if (vertex != std::nullopt)
                 {
-                    json::Dict item_node;
-                    TransportCatalogue_Router::GraphBuilder::EdgeID edge = graph_builder_->GetEdge(item);
+                    sources.push_back(*vertex);
+                    source_rows.push_back(row);
+                }
+            }
+            std::vector<graph::VertexId> targets;
+            std::vector<size_t> target_columns;
+            for (size_t column = 0; column < column_count; ++column)
+            {
+                const std::optional<unsigned int> vertex = graph_builder_->GetBusID(to[column].AsString());
+                if (vertex != std::nullopt)
+                {
+                    targets.push_back(*vertex);
+                    target_columns.push_back(column);
+                }
+            }
 
-                    item_node.insert({"time"s, edge.weight});
+            auto routes = router_->BuildRouteMatrix(sources, targets, with_items);
+            for (size_t i = 0; i < routes.size(); ++i)
+            {
+                const size_t cell = source_rows[i / targets.size()] * column_count + target_columns[i % targets.size()];
+                if (routes[i] != std::nullopt)
+                {
+                    times[cell] = routes[i]->weight.weight;
+                    if (with_items)
+                    {
+                        graph_routes[cell] = std::move(routes[i]);
+                    }
+                }
+            }
+        }
 
-                    if (edge.span_count == 0)
+        out.StartDict()
+            .Key("request_id").Value(value.at("id").AsInt());
+        if (with_items)
+        {
+            out.Key("routes").StartArray();
+            for (size_t row = 0; row < from.size(); ++row)
+            {
+                out.StartArray();
+                for (size_t cell = row * column_count; cell < (row + 1) * column_count; ++cell)
+                {
+                    if (times[cell] == std::nullopt)
                     {
-                        item_node.insert({"stop_name"s, std::string{edge.name}});
-                        item_node.insert({"type"s, "Wait"s});
+                        out.Value(nullptr);
+                        continue;
+                    }
+                    out.StartDict().Key("items");
+                    if (raptor_router_ != nullptr)
+                    {
+                        WriteLegItems(out, raptor_routes[cell]->legs);
                     }
                     else
                     {
-                        item_node.insert({"bus"s, std::string{edge.name}});
-                        item_node.insert({"type"s, "Bus"s});
-                        item_node.insert({"span_count"s, edge.span_count});
+                        WriteRouteItems(out, graph_routes[cell]->edges);
                     }
-
-                    items.push_back(std::move(item_node));
+                    out.Key("total_time").Value(*times[cell])
+                        .EndDict();
                 }
-
-                return out.StartDict().Key("items"s).Value(std::move(items))
-                                    .Key("request_id"s).Value(value.at("id"s))
-                                    .Key("total_time"s).Value(route->weight.weight)
-                                    .EndDict().Build();
+                out.EndArray();
             }
+            out.EndArray();
         }
-
-        return out.StartDict().Key("request_id"s).Value(value.at("id"s).AsInt()).Key("error_message"s).Value("not found"s).EndDict().Build();
+        out.Key("times").StartArray();
+        for (size_t row = 0; row < from.size(); ++row)
+        {
+            out.StartArray();
+            for (size_t cell = row * column_count; cell < (row + 1) * column_count; ++cell)
+            {
+                if (times[cell] != std::nullopt)
+                {
+                    out.Value(*times[cell]);
+                }
+                else
+                {
+                    out.Value(nullptr);
+                }
+            }
+            out.EndArray();
+        }
+        out.EndArray()
+            .EndDict();
     }
 
     bool JsonReader::RunCreateRouter()
     {
+        if (router_settings_.mode == TransportCatalogue_Router::RouterMode::RAPTOR)
+        {
+            if (raptor_router_ == nullptr)
+            {
+                CreateRouter();
+                return true;
+            }
+            return false;
+        }
         if (graph_builder_ == nullptr || router_ == nullptr)
         {
             CreateRouter();
@@ -221,37 +465,85 @@ namespace NS_TransportCatalogue::Interfaces
         return false;
     }
 
+    void JsonReader::ParseStopOrBus(const json::Dict& value)
+    {
+        const auto& curr_type = value.at("type").AsString();
+        if (curr_type == "Bus")
+        {
+            RequestHandler::UploadBus(ReadBus(value));
+        }
+        else if (curr_type == "Stop")
+        {
+            auto stop = ReadStop(value);
+            RequestHandler::UploadStop(std::move(stop.first), stop.second.second);
+        }
+    }
+
     void JsonReader::ParseArrayStopAndBus(const json::Array& array)
     {
-        std::list<TransportCatalogue::BusInput> bus_to_add;
-        std::list<Stop_to_Stop_len> root_length;
-        std::list<domain::Stop> stops_to_add;
-    
         for (const auto& value : array)
         {
-            const json::Dict& current_value = value.AsDict();
-
-            const auto& curr_type = current_value.at("type").AsString();
-            if (curr_type == "Bus")
-            {
-                bus_to_add.push_back(ReadBus(current_value));
-            }
-            else if (curr_type == "Stop")
-            {
-
-                auto stop = ReadStop(current_value);
+            ParseStopOrBus(value.AsDict());
+        }
+        RequestHandler::FinishUpload();
+    }
 
-                stops_to_add.push_back(std::move(stop.first));
-                root_length.push_back(stop.second);
+    TransportCatalogue_Router::RouterMode ParseRouterMode(const std::string& mode)
+    {
+        if (mode == "all_pairs")
+        {
+            return TransportCatalogue_Router::RouterMode::ALL_PAIRS;
+        }
+        else if (mode == "dijkstra")
+        {
+            return TransportCatalogue_Router::RouterMode::DIJKSTRA;
+        }
+        else if (mode == "contraction_hierarchies")
+        {
+            return TransportCatalogue_Router::RouterMode::CONTRACTION_HIERARCHIES;
+        }
+        else if (mode == "raptor")
+        {
+            return TransportCatalogue_Router::RouterMode::RAPTOR;
+        }
+        throw std::invalid_argument("router settings error: unknown router mode - " + mode);
+    }
 
-            }
+    TransportCatalogue_Router::GraphModel ParseGraphModel(const std::string& model)
+    {
+        if (model == "span_edges")
+        {
+            return TransportCatalogue_Router::GraphModel::SPAN_EDGES;
+        }
+        else if (model == "linear")
+        {
+            return TransportCatalogue_Router::GraphModel::LINEAR;
         }
-        RequestHandler::UploadContent(std::move(stops_to_add), std::move(root_length), std::move(bus_to_add));
+        throw std::invalid_argument("router settings error: unknown graph model - " + model);
     }
 
     TransportCatalogue_Router::RouterSettings ParseRoutingSettings(const json::Dict& value)
     {
-        return {value.at("bus_velocity").AsDouble(), value.at("bus_wait_time").AsDouble()};
+        TransportCatalogue_Router::RouterSettings settings{value.at("bus_velocity").AsDouble(), value.at("bus_wait_time").AsDouble()};
+
+        const auto iter_mode = value.find("router_mode");
+        if (iter_mode != value.end())
+        {
+            settings.mode = ParseRouterMode(iter_mode->second.AsString());
+        }
+
+        const auto iter_model = value.find("graph_model");
+        if (iter_model != value.end())
+        {
+            settings.graph_model = ParseGraphModel(iter_model->second.AsString());
+        }
+        // в линейной модели вершин в графе больше, чем остановок, в разы, таблица всех пар на них не помещается в память
+        if (settings.graph_model == TransportCatalogue_Router::GraphModel::LINEAR && settings.mode == TransportCatalogue_Router::RouterMode::ALL_PAIRS)
+        {
+            throw std::invalid_argument("router settings error: graph model linear requires router mode dijkstra or contraction_hierarchies");
+        }
+
+        return settings;
     }
 
     void JsonReader::ReadContent()
@@ -285,54 +577,275 @@ namespace NS_TransportCatalogue::Interfaces
                 ParseSerializationSettings(iter_content->second.AsDict());
             }
         }
+        {
+            const auto iter_content = json_root.find("update_requests");
+            if (iter_content != json_root.end())
+            {
+                ParseUpdateRequests(iter_content->second.AsArray());
+            }
+        }
+    }
+
+    void JsonReader::ParseUpdateRequests(const json::Array& array)
+    {
+        base_delta_ = {};
+        for (const auto& request : array)
+        {
+            const json::Dict& value = request.AsDict();
+            const auto& curr_type = value.at("type").AsString();
+            if (curr_type != "Bus" && curr_type != "Stop")
+            {
+                throw std::invalid_argument("update error: unknown type - " + curr_type);
+            }
+
+            const auto iter_remove = value.find("remove");
+            if (iter_remove != value.end() && iter_remove->second.AsBool())
+            {
+                auto& removed = curr_type == "Bus" ? base_delta_.removed_buses : base_delta_.removed_stops;
+                removed.push_back(value.at("name").AsString());
+            }
+            else if (curr_type == "Bus")
+            {
+                base_delta_.buses.push_back(ReadBus(value));
+            }
+            else
+            {
+                auto stop = ReadStop(value);
+                base_delta_.stops.push_back({std::move(stop.first), std::move(stop.second.second)});
+            }
+        }
+    }
+
+    const Base_Update::BaseDelta& JsonReader::GetBaseDelta() const
+    {
+        return base_delta_;
+    }
+
+    void JsonReader::InitUpdated(const JsonReader& previous)
+    {
+        file_path_ = previous.file_path_;
+        base_format_ = previous.base_format_;
+        render_settings_ = previous.render_settings_;
+        router_settings_ = previous.router_settings_;
+
+        if (previous.graph_builder_ == nullptr)
+        {
+            CreateRouter();
+            return;
+        }
+
+        graph_builder_ = std::make_unique<TransportCatalogue_Router::GraphBuilder>(db_, router_settings_);
+        const Router* previous_router = previous.GetRouterPtr();
+        if (previous_router != nullptr)
+        {
+            router_ = std::make_unique<Router>(graph_builder_->GetGraphRef(), *previous_router, graph_builder_->MapFrom(*previous.graph_builder_), GetPool());
+        }
+        else
+        {
+            // дейкстре нечего обновлять, иерархия сжатий строится заново
+            CreateRouterFromGraph();
+        }
+    }
+
+    bool HasRouteRequest(const json::Dict& root)
+    {
+        const auto iter_requests = root.find("stat_requests");
+        if (iter_requests == root.end())
+        {
+            return false;
+        }
+        const json::Array& content = iter_requests->second.AsArray();
+        return std::any_of(content.begin(), content.end(), [](const json::Node& request)
+        {
+            const json::Dict& request_data = request.AsDict();
+            const auto iter_type = request_data.find("type");
+            return iter_type != request_data.end() && iter_type->second.IsString()
+                && (iter_type->second.AsString() == "Route" || iter_type->second.AsString() == "RouteMatrix");
+        });
     }
 
     void JsonReader::PrintRequest(std::ostream& outstream)
     {
-        json::Print(json::Document{ProcessRequest()}, outstream);
+        const json::Dict& root = json_data_->GetRoot().AsDict();
+        if (HasRouteRequest(root))
+        {
+            RunCreateRouter();
+        }
+        const auto iter_requests = root.find("stat_requests");
+        if (iter_requests != root.end() && iter_requests->second.AsArray().size() >= PARALLEL_REQUEST_COUNT)
+        {
+            GetPool();
+        }
+
+        json::StreamWriter writer(outstream);
+        WriteResponses(writer, root, pool_.get());
     }
 
-    json::Node JsonReader::ProcessRequest()
+    void JsonReader::PrintRequestLine(const json::Document& requests, std::ostream& outstream, thread_pool::ThreadPool* pool) const
     {
-        using namespace std::string_literals;
+        {
+            json::StreamWriter writer(outstream, true);
+            WriteResponses(writer, requests.GetRoot().AsDict(), pool);
+        }
+        outstream.put('\n');
+    }
 
-        const json::Array& content = json_data_->GetRoot().AsDict().at("stat_requests").AsArray();
+    const json::Document& JsonReader::GetDocument() const
+    {
+        return *json_data_;
+    }
 
-        json::Array output;
-        output.reserve(content.size()); 
+    void JsonReader::WriteResponses(json::StreamWriter& out, const json::Dict& root, thread_pool::ThreadPool* pool) const
+    {
+        const auto iter_requests = root.find("stat_requests");
+        if (iter_requests == root.end())
+        {
+            out.StartArray().EndArray();
+            return;
+        }
+        const json::Array& content = iter_requests->second.AsArray();
+
+        // Общее состояние готовится до раздачи запросов потокам: маршрутизатор и карта
+        // строятся один раз, дальше запросы только читают каталог.
+        // Поля запросов проверяются здесь же, до первого выведенного символа: ошибка
+        // в запросе не должна оставить в выводе оборванный ответ
+        std::vector<const json::Dict*> requests;
+        requests.reserve(content.size());
+        bool has_route_request = false;
+        bool has_map_request = false;
         for (const auto& request : content)
         {
             const json::Dict& request_data = request.AsDict();
             const auto& query_type = request_data.at("type").AsString();
-            if ( query_type == "Stop")
-            {
-                output.push_back(ReturnStop(request_data));
-            }
-            else if (query_type == "Bus")
+            if (query_type == "Stop" || query_type == "Bus")
             {
-                output.push_back(ReturnBus(request_data));
+                request_data.at("id").AsInt();
+                request_data.at("name").AsString();
+                requests.push_back(&request_data);
             }
             else if (query_type == "Map")
             {
-                std::stringstream stream;
-                RenderMap(stream);
-                output.emplace_back(json::Builder().StartDict().Key("map"s).Value(std::move(stream).str()).Key("request_id"s).Value(request_data.at("id").AsInt()).EndDict().Build());
+                request_data.at("id").AsInt();
+                has_map_request = true;
+                requests.push_back(&request_data);
             }
             else if (query_type == "Route")
             {
-                output.push_back(ReturnRoute(request_data));
+                request_data.at("id").AsInt();
+                request_data.at("from").AsString();
+                request_data.at("to").AsString();
+                has_route_request = true;
+                requests.push_back(&request_data);
+            }
+            else if (query_type == "RouteMatrix")
+            {
+                request_data.at("id").AsInt();
+                for (const auto& stops : {&request_data.at("from"), &request_data.at("to")})
+                {
+                    for (const auto& stop : stops->AsArray())
+                    {
+                        stop.AsString();
+                    }
+                }
+                const auto iter_items = request_data.find("with_items");
+                if (iter_items != request_data.end())
+                {
+                    iter_items->second.AsBool();
+                }
+                has_route_request = true;
+                requests.push_back(&request_data);
             }
         }
-        return output;
+
+        if (has_route_request && router_ == nullptr && raptor_router_ == nullptr)
+        {
+            throw std::invalid_argument("router error: routing_settings are not set");
+        }
+
+        std::string map;
+        if (has_map_request)
+        {
+            std::stringstream stream;
+            RenderMap(stream);
+            map = std::move(stream).str();
+        }
+
+        out.StartArray();
+
+        if (requests.size() < PARALLEL_REQUEST_COUNT || pool == nullptr)
+        {
+            for (const json::Dict* request : requests)
+            {
+                WriteStatResponse(out, *request, map);
+            }
+            out.EndArray();
+            return;
+        }
+
+        // Пакет обрабатывается порциями: потоки пишут ответы порции в ее слоты, затем
+        // порция по порядку уходит в поток вывода. В памяти одновременно только одна порция
+        std::vector<std::string> answers(std::min(requests.size(), RESPONSE_CHUNK_SIZE));
+        for (size_t chunk_begin = 0; chunk_begin < requests.size(); chunk_begin += RESPONSE_CHUNK_SIZE)
+        {
+            const size_t chunk_size = std::min(RESPONSE_CHUNK_SIZE, requests.size() - chunk_begin);
+            const auto process_range = [this, &requests, &map, &answers, chunk_begin, &out](size_t begin, size_t end)
+            {
+                std::ostringstream stream;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    stream.str({});
+                    {
+                        json::StreamWriter answer_writer(stream, out.IsCompact(), 1);
+                        WriteStatResponse(answer_writer, *requests[chunk_begin + i], map);
+                    }
+                    answers[i] = std::move(stream).str();
+                }
+            };
+
+            const size_t block_size = std::max<size_t>(PARALLEL_REQUEST_COUNT / 4, chunk_size / (pool->GetThreadCount() * 8));
+            pool->ParallelFor(chunk_size, block_size, process_range);
+
+            for (size_t i = 0; i < chunk_size; ++i)
+            {
+                out.RawValue(answers[i]);
+            }
+        }
+
+        out.EndArray();
     }
 
-    void JsonReader::RenderMap(std::ostream& os)
+    void JsonReader::WriteStatResponse(json::StreamWriter& out, const json::Dict& request_data, const std::string& map) const
     {
-        render_ = std::make_unique<MapRenderer>(MapRenderer{std::move(db_.GetBusVector()), GetRenderSettings()});
-        if (render_)
+        const auto& query_type = request_data.at("type").AsString();
+        if (query_type == "Stop")
+        {
+            WriteStop(out, request_data);
+        }
+        else if (query_type == "Bus")
         {
-            render_->Render(os);
+            WriteBus(out, request_data);
         }
+        else if (query_type == "Map")
+        {
+            out.StartDict()
+                .Key("map").Value(map)
+                .Key("request_id").Value(request_data.at("id").AsInt())
+                .EndDict();
+        }
+        else if (query_type == "RouteMatrix")
+        {
+            WriteRouteMatrix(out, request_data);
+        }
+        else
+        {
+            WriteRoute(out, request_data);
+        }
+    }
+
+    void JsonReader::RenderMap(std::ostream& os) const
+    {
+        const MapRenderer render{db_.GetBusVector(), GetRenderSettings()};
+        render.Render(os);
     }
 
     std::optional<JsonReader::Path> JsonReader::GetFilePath()
@@ -340,6 +853,24 @@ namespace NS_TransportCatalogue::Interfaces
         return file_path_;
     }
 
+    BaseFormat JsonReader::GetBaseFormat() const
+    {
+        return base_format_;
+    }
+
+    BaseFormat ParseBaseFormat(const std::string& format)
+    {
+        if (format == "protobuf")
+        {
+            return BaseFormat::PROTOBUF;
+        }
+        else if (format == "image")
+        {
+            return BaseFormat::IMAGE;
+        }
+        throw std::invalid_argument("serialization settings error: unknown base format - " + format);
+    }
+
     void JsonReader::ParseSerializationSettings(const json::Dict& value)
     {
         auto iter = value.find("file");
@@ -347,6 +878,12 @@ namespace NS_TransportCatalogue::Interfaces
         {
             file_path_ = iter->second.AsString();
         }
+
+        iter = value.find("format");
+        if (iter != value.end())
+        {
+            base_format_ = ParseBaseFormat(iter->second.AsString());
+        }
     }
 
     void JsonReader::SetMapReanderSettings(MapRenderer::RenderSetting&& in)
@@ -360,6 +897,18 @@ namespace NS_TransportCatalogue::Interfaces
         router_ = std::make_unique<Router>(graph_builder_->GetGraphRef(), std::forward<Router::InitStruct>(router_init));
     }
 
+    void JsonReader::InitRouter(TransportCatalogue_Router::GraphBuilder::InitStruct&& graph_builder_init, CHRouter::InitStruct&& ch_init)
+    {
+        graph_builder_ = std::make_unique<TransportCatalogue_Router::GraphBuilder>(db_, std::forward<TransportCatalogue_Router::GraphBuilder::InitStruct>(graph_builder_init));
+        router_ = std::make_unique<CHRouter>(graph_builder_->GetGraphRef(), std::forward<CHRouter::InitStruct>(ch_init));
+    }
+
+    void JsonReader::InitRouter(TransportCatalogue_Router::GraphBuilder::InitStruct&& graph_builder_init)
+    {
+        graph_builder_ = std::make_unique<TransportCatalogue_Router::GraphBuilder>(db_, std::forward<TransportCatalogue_Router::GraphBuilder::InitStruct>(graph_builder_init));
+        CreateRouterFromGraph();
+    }
+
     const TransportCatalogue_Router::GraphBuilder* JsonReader::GetGraphBuilderPtr() const
     {
         return graph_builder_.get();
@@ -367,7 +916,13 @@ namespace NS_TransportCatalogue::Interfaces
 
     const graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>* JsonReader::GetRouterPtr() const
     {
-        return router_.get();
+        // таблица всех пар есть только у Router, остальные режимы строят маршрут по запросу
+        return dynamic_cast<const Router*>(router_.get());
+    }
+
+    const graph::ContractionHierarchiesRouter<TransportCatalogue_Router::GraphBuilder::RouterWeight>* JsonReader::GetContractionHierarchiesPtr() const
+    {
+        return dynamic_cast<const CHRouter*>(router_.get());
     }
 
     void JsonReader::SetRouterSettings(TransportCatalogue_Router::RouterSettings&& settings)
@@ -7,10 +7,21 @@
 #include "map_renderer.h"
 #include "json_builder.h"
 #include "transport_router.h"
+#include "raptor_router.h"
+#include "thread_pool.h"
+#include "base_update.h"
 
 
 namespace NS_TransportCatalogue::Interfaces
 {
+
+// формат файла базы, который пишет make_base
+enum class BaseFormat
+{
+    PROTOBUF,
+    IMAGE
+};
+
 class JsonReader final : public RequestHandler
 {
 private:
@@ -19,32 +30,52 @@ private:
     using DWGraph = graph::DirectedWeightedGraph<TransportCatalogue_Router::GraphBuilder::RouterWeight>;
     using Router = graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>;
     using Graph_ptr = std::unique_ptr<TransportCatalogue_Router::GraphBuilder>;
-    using Router_ptr = std::unique_ptr<graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>>;
+    using RouterBase = graph::RouterBase<TransportCatalogue_Router::GraphBuilder::RouterWeight>;
+    using CHRouter = graph::ContractionHierarchiesRouter<TransportCatalogue_Router::GraphBuilder::RouterWeight>;
+    using Router_ptr = std::unique_ptr<RouterBase>;
 
     std::unique_ptr<json::Document> json_data_{nullptr};
-    std::unique_ptr<MapRenderer> render_{nullptr};
     std::optional<Path> file_path_{std::nullopt};
+    BaseFormat base_format_ = BaseFormat::PROTOBUF;
     MapRenderer::RenderSetting render_settings_;
     
 
     TransportCatalogue_Router::RouterSettings router_settings_;
     Graph_ptr graph_builder_{nullptr};
     Router_ptr router_{nullptr};
+    std::unique_ptr<TransportCatalogue_Router::RaptorRouter> raptor_router_{nullptr};
+    // пул потоков для больших пакетов stat_requests и расчета таблицы всех пар, создается GetPool
+    std::unique_ptr<thread_pool::ThreadPool> pool_{nullptr};
+    Base_Update::BaseDelta base_delta_;
+
+    // с какого размера пакета stat_requests обрабатываются пулом потоков
+    static constexpr size_t PARALLEL_REQUEST_COUNT = 256;
+    // сколько ответов пула потоков копится перед записью в поток вывода
+    static constexpr size_t RESPONSE_CHUNK_SIZE = 4096;
 
     void ReadContent();
-    json::Node ProcessRequest();
+    void WriteResponses(json::StreamWriter& out, const json::Dict& root, thread_pool::ThreadPool* pool) const;
+    void WriteStatResponse(json::StreamWriter& out, const json::Dict& request_data, const std::string& map) const;
     
     TransportCatalogue::BusInput ReadBus(const json::Dict& value) const;
     std::pair<domain::Stop, Stop_to_Stop_len> ReadStop(const json::Dict& value) const;
     MapRenderer::RenderSetting ReadRenderSetting(const json::Dict& value) const;
-    json::Node ReturnStop(const json::Dict& value) const;
-    json::Node ReturnBus(const json::Dict& value) const;
-    json::Node ReturnRoute(const json::Dict& value);
+    void WriteNotFound(json::StreamWriter& out, const json::Dict& value) const;
+    void WriteStop(json::StreamWriter& out, const json::Dict& value) const;
+    void WriteBus(json::StreamWriter& out, const json::Dict& value) const;
+    void WriteRoute(json::StreamWriter& out, const json::Dict& value) const;
+    void WriteRaptorRoute(json::StreamWriter& out, const json::Dict& value) const;
+    void WriteRouteMatrix(json::StreamWriter& out, const json::Dict& value) const;
+    void WriteRouteItems(json::StreamWriter& out, const std::vector<graph::EdgeId>& edges) const;
     svg::Color GetColor(const json::Node& color_array) const;
+    void ParseStopOrBus(const json::Dict& value);
     void ParseArrayStopAndBus(const json::Array& array);
     void ParseSerializationSettings(const json::Dict& value);
+    void ParseUpdateRequests(const json::Array& array);
 
     void CreateRouter();
+    void CreateRouterFromGraph();
+    thread_pool::ThreadPool* GetPool();
 
 
 public:
@@ -55,13 +86,28 @@ public:
     const TransportCatalogue_Router::RouterSettings& GetRouterSettings() const;
     const TransportCatalogue_Router::GraphBuilder* GetGraphBuilderPtr() const;
     const graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>* GetRouterPtr() const;
+    const graph::ContractionHierarchiesRouter<TransportCatalogue_Router::GraphBuilder::RouterWeight>* GetContractionHierarchiesPtr() const;
     void ReadInput(std::istream& instream) override;
     void PrintRequest(std::ostream& outstream) override;
-    void RenderMap(std::ostream& os);
+    // Ответ одной строкой на stat_requests документа requests, для потокового режима serve.
+    // Ничего не меняет в объекте, маршрутизатор должен быть построен заранее (RunCreateRouter).
+    // Большие пакеты раздаются пулу pool, если он передан
+    void PrintRequestLine(const json::Document& requests, std::ostream& outstream, thread_pool::ThreadPool* pool) const;
+    // документ, прочитанный ReadInput, без base_requests
+    const json::Document& GetDocument() const;
+    void RenderMap(std::ostream& os) const;
     std::optional<JsonReader::Path> GetFilePath();
+    BaseFormat GetBaseFormat() const;
     bool RunCreateRouter();
     void SetMapReanderSettings(MapRenderer::RenderSetting&& in);
     void SetRouterSettings(TransportCatalogue_Router::RouterSettings&& settings);
     void InitRouter(TransportCatalogue_Router::GraphBuilder::InitStruct&& graph_builder_init, Router::InitStruct&& router_init);
+    void InitRouter(TransportCatalogue_Router::GraphBuilder::InitStruct&& graph_builder_init, CHRouter::InitStruct&& ch_init);
+    void InitRouter(TransportCatalogue_Router::GraphBuilder::InitStruct&& graph_builder_init);
+    // изменения базы из update_requests
+    const Base_Update::BaseDelta& GetBaseDelta() const;
+    // настройки и маршрутизатор для базы, собранной из базы previous: таблица всех пар
+    // пересчитывается только в изменившихся строках
+    void InitUpdated(const JsonReader& previous);
 };
 } // end namespace NS_TransportCatalogue::Interfaces
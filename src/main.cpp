@@ -1,4 +1,5 @@
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <string_view>
 #include <sstream>
@@ -6,12 +7,14 @@
 #include "request_handler.h"
 #include "json_reader.h"
 #include "serialization.h"
+#include "base_update.h"
+#include "base_snapshot.h"
 
 using namespace std::literals;
 using Path = std::filesystem::path;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|update_base|process_requests|serve]\n"sv;
 }
 
 void SerializationTC(const std::optional<Path>& file, const NS_TransportCatalogue::TransportCatalogue& db, const NS_TransportCatalogue::Interfaces::JsonReader& reader)
@@ -30,7 +33,16 @@ void SerializationTC(const std::optional<Path>& file, const NS_TransportCatalogu
         s_worker.SetRouterSettings(&reader.GetRouterSettings());
         s_worker.SetGraphBuilder(reader.GetGraphBuilderPtr());
         s_worker.SetRouter(reader.GetRouterPtr());
-        s_worker.RunSerealization(out);
+        s_worker.SetContractionHierarchies(reader.GetContractionHierarchiesPtr());
+
+        if (reader.GetBaseFormat() == NS_TransportCatalogue::Interfaces::BaseFormat::IMAGE)
+        {
+            s_worker.RunSerealizationImage(out);
+        }
+        else
+        {
+            s_worker.RunSerealization(out);
+        }
     }
 }
 
@@ -48,17 +60,38 @@ void DeserializationTC(const std::optional<Path>& file, NS_TransportCatalogue::T
 {
     if (file)
     {
-        std::ifstream ifs(*file, std::ios::binary);
-        if (!ifs.good())
-        {
-            throw std::runtime_error("can't open file - "s + file->string());
-        }
-
         NS_TransportCatalogue::Serealization_Worker::Deserealization d_worker(db);
-        d_worker.RunDeserealization(ifs, reader);
+        d_worker.RunDeserealization(*file, reader);
     }
 }
 
+// Прежняя база загружается из serialization_settings, к ней применяются update_requests.
+// Новая база пишется во временный файл и подменяет прежнюю переименованием: прежний файл
+// может быть отображен в память, пока идет запись
+void UpdateBase(std::istream& in)
+{
+    NS_TransportCatalogue::TransportCatalogue db;
+    NS_TransportCatalogue::Interfaces::JsonReader reader{db};
+    reader.ReadInput(in);
+
+    const std::optional<Path> file = reader.GetFilePath();
+    if (!file)
+    {
+        throw std::invalid_argument("update error: serialization_settings file is not set");
+    }
+    DeserializationTC(file, db, reader);
+
+    NS_TransportCatalogue::TransportCatalogue updated_db;
+    NS_TransportCatalogue::Base_Update::BaseUpdater(db).Apply(reader.GetBaseDelta(), updated_db);
+    NS_TransportCatalogue::Interfaces::JsonReader updated_reader{updated_db};
+    updated_reader.InitUpdated(reader);
+
+    Path temp_file = *file;
+    temp_file += ".update";
+    SerializationTC(temp_file, updated_db, updated_reader);
+    std::filesystem::rename(temp_file, *file);
+}
+
 void ProcessRequests(std::istream& in, std::ostream& out)
 {
     NS_TransportCatalogue::TransportCatalogue db;
@@ -70,6 +103,89 @@ void ProcessRequests(std::istream& in, std::ostream& out)
     reader.PrintRequest(out);
 }
 
+void PrintErrorLine(const std::string& message, std::ostream& out)
+{
+    json::PrintCompact(json::Document{json::Builder().StartDict().Key("error_message"s).Value(message).EndDict().Build()}, out);
+    out.put('\n');
+}
+
+// Ошибка завершенной фоновой загрузки выводится строкой {"error_message": "reload error: ..."},
+// с wait загрузка сначала дожидается завершения
+void ReportReload(std::future<void>& reload, bool wait, std::ostream& out)
+{
+    if (!reload.valid() || (!wait && reload.wait_for(0s) != std::future_status::ready))
+    {
+        return;
+    }
+    try
+    {
+        reload.get();
+    }
+    catch (const std::exception& e)
+    {
+        PrintErrorLine("reload error: "s + e.what(), out);
+    }
+}
+
+// Каждая строка входа - отдельный JSON-документ, на каждую выводится строка с ответом.
+// Первый документ задает serialization_settings, по ним загружается снимок базы.
+// Следующий документ с serialization_settings запускает сборку нового снимка в фоновом потоке:
+// пока она идет, запросы, включая запросы этого документа, отвечает прежний снимок,
+// готовый снимок подменяет его атомарно. Если загрузка не удалась, перед ответом на следующий
+// документ (или в конце ввода) выводится дополнительная строка с ошибкой, работает прежний снимок
+void Serve(std::istream& in, std::ostream& out)
+{
+    using NS_TransportCatalogue::Interfaces::BaseSnapshot;
+
+    NS_TransportCatalogue::Interfaces::SnapshotHolder holder;
+    thread_pool::ThreadPool pool;
+    std::future<void> reload;
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.find_first_not_of(" \t\r"sv) == std::string::npos)
+        {
+            continue;
+        }
+
+        ReportReload(reload, false, out);
+        try
+        {
+            std::istringstream line_stream(line);
+            const std::shared_ptr<const BaseSnapshot> snapshot = holder.Get();
+            if (!snapshot)
+            {
+                const std::shared_ptr<const BaseSnapshot> loaded = BaseSnapshot::Load(line_stream);
+                holder.Publish(loaded);
+                loaded->GetReader().PrintRequestLine(loaded->GetReader().GetDocument(), out, &pool);
+            }
+            else
+            {
+                const json::Document requests = json::Load(line_stream, json::Allocation::ARENA);
+                if (requests.GetRoot().AsDict().count("serialization_settings"))
+                {
+                    ReportReload(reload, true, out);
+                    reload = std::async(std::launch::async, [&holder, text = line]()
+                    {
+                        std::istringstream text_stream(text);
+                        holder.Publish(BaseSnapshot::Load(text_stream));
+                    });
+                }
+                snapshot->GetReader().PrintRequestLine(requests, out, &pool);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            PrintErrorLine(e.what(), out);
+        }
+        out.flush();
+    }
+
+    ReportReload(reload, true, out);
+    out.flush();
+}
+
 int main(int argc, char* argv[]) {
 
    if (argc != 2) {
@@ -84,6 +200,12 @@ int main(int argc, char* argv[]) {
 
         MakeBase(std::cin);
 
+    }
+    else if (mode == "update_base"sv)
+    {
+
+        UpdateBase(std::cin);
+
     }
     else if (mode == "process_requests"sv) 
     {
@@ -91,6 +213,13 @@ int main(int argc, char* argv[]) {
         ProcessRequests(std::cin, std::cout);
 
     }
+    else if (mode == "serve"sv)
+    {
+        std::ios::sync_with_stdio(false);
+        std::cin.tie(nullptr);
+
+        Serve(std::cin, std::cout);
+    }
     else
     {
         PrintUsage();
@@ -54,7 +54,7 @@ void MapRenderer::Render_worker::LineRender(const domain::Bus& bus, svg::Color c
     {
         if (!trig)
         {
-            bus_names.push_back(CreateBusName(projector(stop->coordinates), bus.name, color));
+            bus_names.push_back(CreateBusName(projector(stop->coordinates), std::string{bus.name}, color));
             trig = true;
         }
 
@@ -64,7 +64,7 @@ void MapRenderer::Render_worker::LineRender(const domain::Bus& bus, svg::Color c
     {
         if (bus.stops.front()->coordinates != bus.stops.back()->coordinates)
         {
-            bus_names.push_back(CreateBusName(projector((*bus.stops.crbegin())->coordinates), bus.name, color));
+            bus_names.push_back(CreateBusName(projector((*bus.stops.crbegin())->coordinates), std::string{bus.name}, color));
         }
         
         for (auto i = bus.stops.crbegin() + 1; i != bus.stops.crend(); ++i)
@@ -0,0 +1,271 @@
+#include <algorithm>
+
+#include "raptor_router.h"
+
+namespace NS_TransportCatalogue::TransportCatalogue_Router
+{
+
+RaptorRouter::RaptorRouter(const NS_TransportCatalogue::TransportCatalogue& catalog, RouterSettings settings)
+    : catalog_(catalog), settings_(settings), stop_count_(catalog.GetStopCount())
+{
+    for (const auto& bus : catalog_.GetBusList())
+    {
+        if (bus.stops.size() < 2)
+        {
+            continue;
+        }
+
+        // направления маршрута FORWARD - отдельные цепочки, проехать конечную без пересадки нельзя
+        AddChain(bus, false);
+        if (bus.root_type == domain::BussRootType::FORWARD)
+        {
+            AddChain(bus, true);
+        }
+    }
+    IndexChainStops();
+}
+
+void RaptorRouter::AddChain(const domain::Bus& bus, bool reversed)
+{
+    const auto& stops = bus.stops;
+    const auto& hop_lengths = reversed ? bus.reverse_hop_lengths : bus.hop_lengths;
+    const size_t last = stops.size() - 1;
+
+    chains_.push_back({&bus, static_cast<uint32_t>(chain_stops_.size()), static_cast<uint32_t>(stops.size())});
+    for (size_t k = 0; k <= last; ++k)
+    {
+        const size_t stop = reversed ? last - k : k;
+        chain_stops_.push_back(static_cast<uint32_t>(stops[stop]->id));
+        if (k == last)
+        {
+            chain_ride_times_.push_back(0);
+            continue;
+        }
+
+        const unsigned int length = hop_lengths[reversed ? stop - 1 : stop];
+        chain_ride_times_.push_back(length / ((settings_.bus_speed * 1000) / 60));
+    }
+}
+
+void RaptorRouter::IndexChainStops()
+{
+    // с последней позиции цепочки уехать некуда, в индекс она не попадает
+    stop_chain_begins_.assign(stop_count_ + 1, 0);
+    for (const Chain& chain : chains_)
+    {
+        for (uint32_t position = 0; position + 1 < chain.count; ++position)
+        {
+            ++stop_chain_begins_[chain_stops_[chain.first + position] + 1];
+        }
+    }
+    for (size_t stop = 0; stop < stop_count_; ++stop)
+    {
+        stop_chain_begins_[stop + 1] += stop_chain_begins_[stop];
+    }
+
+    stop_chains_.resize(stop_chain_begins_.back());
+    std::vector<uint32_t> cursors(stop_chain_begins_.begin(), stop_chain_begins_.end() - 1);
+    for (uint32_t chain_id = 0; chain_id < chains_.size(); ++chain_id)
+    {
+        const Chain& chain = chains_[chain_id];
+        for (uint32_t position = 0; position + 1 < chain.count; ++position)
+        {
+            stop_chains_[cursors[chain_stops_[chain.first + position]]++] = {chain_id, position};
+        }
+    }
+}
+
+std::optional<RaptorRouter::RouteInfo> RaptorRouter::BuildRoute(const domain::Stop* from, const domain::Stop* to) const
+{
+    const uint32_t source = static_cast<uint32_t>(from->id);
+    const uint32_t target = static_cast<uint32_t>(to->id);
+    if (source == target)
+    {
+        return RouteInfo{};
+    }
+
+    Scratch& scratch = GetScratch();
+    RunSearch(source, target, scratch);
+    if (scratch.best_times[target] == UNREACHED)
+    {
+        return std::nullopt;
+    }
+    return CollectLegs(scratch, source, target);
+}
+
+std::vector<std::optional<RaptorRouter::RouteInfo>> RaptorRouter::BuildRoutes(const domain::Stop* from,
+    const std::vector<const domain::Stop*>& targets, bool with_legs) const
+{
+    const uint32_t source = static_cast<uint32_t>(from->id);
+    Scratch& scratch = GetScratch();
+    RunSearch(source, NO_STOP, scratch);
+
+    std::vector<std::optional<RouteInfo>> out;
+    out.reserve(targets.size());
+    for (const domain::Stop* to : targets)
+    {
+        const uint32_t target = static_cast<uint32_t>(to->id);
+        if (target == source)
+        {
+            out.push_back(RouteInfo{});
+        }
+        else if (scratch.best_times[target] == UNREACHED)
+        {
+            out.push_back(std::nullopt);
+        }
+        else if (with_legs)
+        {
+            out.push_back(CollectLegs(scratch, source, target));
+        }
+        else
+        {
+            out.push_back(RouteInfo{scratch.best_times[target], {}});
+        }
+    }
+    return out;
+}
+
+void RaptorRouter::Scratch::Prepare(size_t stop_count, size_t chain_count)
+{
+    if (labels.size() != stop_count)
+    {
+        labels.assign(stop_count, Label{});
+        best_times.assign(stop_count, UNREACHED);
+        is_marked.assign(stop_count, 0);
+    }
+    else
+    {
+        for (uint32_t stop : touched_stops)
+        {
+            labels[stop] = Label{};
+            best_times[stop] = UNREACHED;
+        }
+    }
+    if (chain_starts.size() != chain_count)
+    {
+        chain_starts.assign(chain_count, NO_POSITION);
+    }
+    touched_stops.clear();
+    round_labels.clear();
+    marked_stops.clear();
+    queued_chains.clear();
+}
+
+void RaptorRouter::RunSearch(uint32_t source, uint32_t target, Scratch& scratch) const
+{
+    scratch.Prepare(stop_count_, chains_.size());
+    scratch.labels[source].time = 0;
+    scratch.best_times[source] = 0;
+    scratch.touched_stops.push_back(source);
+    scratch.marked_stops.push_back(source);
+
+    // каждый раунд добавляет поездку, без улучшений за раунд поиск закончен
+    while (!scratch.marked_stops.empty())
+    {
+        for (uint32_t stop : scratch.marked_stops)
+        {
+            scratch.is_marked[stop] = 0;
+            for (uint32_t i = stop_chain_begins_[stop]; i < stop_chain_begins_[stop + 1]; ++i)
+            {
+                const ChainStop& chain_stop = stop_chains_[i];
+                uint32_t& start = scratch.chain_starts[chain_stop.chain];
+                if (start == NO_POSITION)
+                {
+                    scratch.queued_chains.push_back(chain_stop.chain);
+                }
+                start = std::min(start, chain_stop.position);
+            }
+        }
+        scratch.marked_stops.clear();
+
+        for (uint32_t chain_id : scratch.queued_chains)
+        {
+            ScanChain(chain_id, scratch.chain_starts[chain_id], target, scratch);
+            scratch.chain_starts[chain_id] = NO_POSITION;
+        }
+        scratch.queued_chains.clear();
+
+        // метки раунда вступают в силу после просмотра всех цепочек, последняя метка остановки - лучшая
+        for (const auto& [stop, label] : scratch.round_labels)
+        {
+            scratch.labels[stop] = label;
+        }
+        scratch.round_labels.clear();
+    }
+}
+
+void RaptorRouter::ScanChain(uint32_t chain_id, uint32_t start, uint32_t target, Scratch& scratch) const
+{
+    const Chain& chain = chains_[chain_id];
+
+    double on_board_time = UNREACHED;
+    uint32_t board_position = NO_POSITION;
+    for (uint32_t position = start; position < chain.count; ++position)
+    {
+        const uint32_t stop = chain_stops_[chain.first + position];
+
+        // высадка: улучшение не хуже лучшего времени до цели не интересно
+        const double target_time = target == NO_STOP ? UNREACHED : scratch.best_times[target];
+        if (board_position != NO_POSITION && on_board_time < std::min(scratch.best_times[stop], target_time))
+        {
+            if (scratch.best_times[stop] == UNREACHED)
+            {
+                scratch.touched_stops.push_back(stop);
+            }
+            scratch.best_times[stop] = on_board_time;
+            scratch.round_labels.push_back({stop, {on_board_time, chain_id, board_position, position}});
+            if (!scratch.is_marked[stop])
+            {
+                scratch.is_marked[stop] = 1;
+                scratch.marked_stops.push_back(stop);
+            }
+        }
+
+        if (position + 1 == chain.count)
+        {
+            break;
+        }
+
+        // посадка по метке прошлого раунда, если с ней в автобусе окажемся раньше
+        const double board_time = scratch.labels[stop].time + settings_.bus_wait_time;
+        if (board_time < on_board_time)
+        {
+            on_board_time = board_time;
+            board_position = position;
+        }
+        on_board_time += chain_ride_times_[chain.first + position];
+    }
+}
+
+RaptorRouter::RouteInfo RaptorRouter::CollectLegs(const Scratch& scratch, uint32_t from, uint32_t to) const
+{
+    RouteInfo out;
+    out.total_time = scratch.labels[to].time;
+
+    // метка остановки посадки могла улучшиться после посадки, путь по ней не длиннее,
+    // а для найденного лучшего времени до to - той же длины
+    uint32_t stop = to;
+    while (stop != from)
+    {
+        const Label& label = scratch.labels[stop];
+        const Chain& chain = chains_[label.chain];
+        const uint32_t board_stop = chain_stops_[chain.first + label.board_position];
+
+        // время в пути суммируется по перегонам от посадки, как накопленный вес ребра графа
+        double ride_time = 0;
+        for (uint32_t position = label.board_position; position < label.alight_position; ++position)
+        {
+            ride_time += chain_ride_times_[chain.first + position];
+        }
+
+        out.legs.push_back({&catalog_.GetStopList()[board_stop], settings_.bus_wait_time, chain.bus->name,
+            static_cast<int>(label.alight_position - label.board_position), ride_time});
+
+        stop = board_stop;
+    }
+
+    std::reverse(out.legs.begin(), out.legs.end());
+    return out;
+}
+
+} // end namespace NS_TransportCatalogue::TransportCatalogue_Router
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "transport_router.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace NS_TransportCatalogue::TransportCatalogue_Router
+{
+
+// Поиск маршрута по раундам (RAPTOR) прямо по последовательностям остановок маршрутов, без графа
+// и предрасчета. Каждое направление маршрута - цепочка остановок, раунд k просматривает цепочки
+// через остановки, улучшенные в раунде k - 1, и находит лучшее время с k поездками.
+// Посадка стоит bus_wait_time, перегон - длина по дорогам при скорости bus_speed
+class RaptorRouter
+{
+public:
+
+    // одна поездка: ожидание на остановке посадки и span_count перегонов на автобусе bus
+    struct Leg
+    {
+        const domain::Stop* board_stop = nullptr;
+        double wait_time = 0;
+        std::string_view bus;
+        int span_count = 0;
+        double ride_time = 0;
+    };
+
+    struct RouteInfo
+    {
+        double total_time = 0;
+        std::vector<Leg> legs;
+    };
+
+    RaptorRouter(const NS_TransportCatalogue::TransportCatalogue& catalog, RouterSettings settings);
+
+    std::optional<RouteInfo> BuildRoute(const domain::Stop* from, const domain::Stop* to) const;
+    // маршруты из from во все targets одним поиском без отсечения по цели, без with_legs - только время
+    std::vector<std::optional<RouteInfo>> BuildRoutes(const domain::Stop* from, const std::vector<const domain::Stop*>& targets,
+        bool with_legs) const;
+
+private:
+
+    static constexpr uint32_t NO_POSITION = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t NO_STOP = std::numeric_limits<uint32_t>::max();
+    static constexpr double UNREACHED = std::numeric_limits<double>::infinity();
+
+    // направление маршрута: позиции first .. first + count - 1 в chain_stops_ и chain_ride_times_
+    struct Chain
+    {
+        const domain::Bus* bus = nullptr;
+        uint32_t first = 0;
+        uint32_t count = 0;
+    };
+
+    // остановка входит в цепочку chain на позиции position, с которой можно уехать дальше
+    struct ChainStop
+    {
+        uint32_t chain = 0;
+        uint32_t position = 0;
+    };
+
+    // метка остановки: время прибытия и поездка, которой оно получено
+    struct Label
+    {
+        double time = UNREACHED;
+        uint32_t chain = 0;
+        uint32_t board_position = NO_POSITION;
+        uint32_t alight_position = NO_POSITION;
+    };
+
+    // Рабочие буферы запроса, переиспользуются между запросами потока. Массивы по остановкам
+    // не заполняются заново: перед запросом сбрасываются только остановки из touched_stops,
+    // is_marked и chain_starts к концу поиска возвращаются в исходное состояние сами
+    struct Scratch
+    {
+        // метки на конец прошлого раунда, по ним идет посадка
+        std::vector<Label> labels;
+        // лучшее время с учетом улучшений текущего раунда
+        std::vector<double> best_times;
+        std::vector<uint32_t> touched_stops;
+        // улучшения текущего раунда, переносятся в labels после просмотра всех цепочек
+        std::vector<std::pair<uint32_t, Label>> round_labels;
+        std::vector<char> is_marked;
+        std::vector<uint32_t> marked_stops;
+        std::vector<uint32_t> chain_starts;
+        std::vector<uint32_t> queued_chains;
+
+        void Prepare(size_t stop_count, size_t chain_count);
+    };
+
+    const NS_TransportCatalogue::TransportCatalogue& catalog_;
+    RouterSettings settings_;
+    size_t stop_count_ = 0;
+
+    std::vector<Chain> chains_;
+    std::vector<uint32_t> chain_stops_;
+    // время перегона от позиции к следующей, у последней позиции цепочки не используется
+    std::vector<double> chain_ride_times_;
+    // цепочки через остановку: stop_chains_[stop_chain_begins_[id] .. stop_chain_begins_[id + 1])
+    std::vector<uint32_t> stop_chain_begins_;
+    std::vector<ChainStop> stop_chains_;
+
+    void AddChain(const domain::Bus& bus, bool reversed);
+    void IndexChainStops();
+
+    // target == NO_STOP - поиск без отсечения
+    void RunSearch(uint32_t source, uint32_t target, Scratch& scratch) const;
+    void ScanChain(uint32_t chain_id, uint32_t start, uint32_t target, Scratch& scratch) const;
+    RouteInfo CollectLegs(const Scratch& scratch, uint32_t from, uint32_t to) const;
+
+    static Scratch& GetScratch()
+    {
+        static thread_local Scratch scratch;
+        return scratch;
+    }
+}; // end RaptorRouter
+
+} // end namespace NS_TransportCatalogue::TransportCatalogue_Router
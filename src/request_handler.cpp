@@ -2,16 +2,41 @@
 
 namespace NS_TransportCatalogue
 {
-    void RequestHandler::UploadContent(std::list<domain::Stop>&& stops_to_add, 
-                                std::list<std::pair<std::string_view, std::vector<std::pair<std::string_view, unsigned int>>>>&& root_length,
-                                std::list<NS_TransportCatalogue::TransportCatalogue::BusInput>&& bus_to_add
-                                )
+    void RequestHandler::UploadStop(domain::Stop&& stop, const std::vector<std::pair<std::string_view, unsigned int>>& road_distances)
     {
-        db_.AddStop(std::move(stops_to_add), std::move(root_length));
-        for (auto& bus : bus_to_add)
+        const std::string_view from = db_.InternName(stop.name);
+        db_.AddStop(std::move(stop));
+
+        for (const auto& [to, length] : road_distances)
+        {
+            pending_distances_.push_back({from, db_.InternName(to), length});
+        }
+    }
+
+    void RequestHandler::UploadBus(NS_TransportCatalogue::TransportCatalogue::BusInput&& bus)
+    {
+        for (auto& stop : bus.stops)
+        {
+            stop = db_.InternName(stop);
+        }
+        pending_buses_.push_back(std::move(bus));
+    }
+
+    void RequestHandler::FinishUpload()
+    {
+        // порядок как при загрузке целиком: все остановки, затем расстояния, затем маршруты
+        for (const auto& distance : pending_distances_)
+        {
+            db_.AddDistance(distance.from, distance.to, distance.length);
+        }
+        pending_distances_.clear();
+        pending_distances_.shrink_to_fit();
+
+        for (auto& bus : pending_buses_)
         {
             db_.AddBus(std::move(bus));
         }
+        pending_buses_.clear();
+        pending_buses_.shrink_to_fit();
     }
 } // end namespace NS_TransportCatalogue
-
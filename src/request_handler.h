@@ -19,12 +19,26 @@ protected:
     RequestHandler(TransportCatalogue& db): db_(db) {}
     ~RequestHandler() = default;
 
-    virtual void UploadContent(std::list<domain::Stop>&& stops_to_add, 
-                                std::list<Stop_to_Stop_len>&& root_length,
-                                std::list<NS_TransportCatalogue::TransportCatalogue::BusInput>&& bus_to_add
-                                ) final;
+    // Потоковое наполнение базы. Остановки попадают в базу сразу, а расстояния и маршруты
+    // могут ссылаться на еще не прочитанные остановки, поэтому откладываются до FinishUpload.
+    // Имена из входных данных копируются в пул базы, входные данные можно освобождать сразу
+    void UploadStop(domain::Stop&& stop, const std::vector<std::pair<std::string_view, unsigned int>>& road_distances);
+    void UploadBus(NS_TransportCatalogue::TransportCatalogue::BusInput&& bus);
+    void FinishUpload();
 
     TransportCatalogue& db_;
+
+private:
+
+    struct PendingDistance
+    {
+        std::string_view from;
+        std::string_view to;
+        unsigned int length;
+    };
+
+    std::vector<PendingDistance> pending_distances_;
+    std::vector<NS_TransportCatalogue::TransportCatalogue::BusInput> pending_buses_;
 };
 } // end namespace NS_TransportCatalogue
 // */
\ No newline at end of file
@@ -1,11 +1,15 @@
 #pragma once
 
 #include "graph.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <stdexcept>
 #include <unordered_map>
@@ -14,37 +18,155 @@
 
 namespace graph {
 
+// Рабочие буферы поиска Дейкстры, переиспользуются между запросами.
+// Метки visit_marks позволяют не очищать weights/prev_edges перед каждым поиском.
 template <typename Weight>
-class Router {
-private:
-    using Graph = DirectedWeightedGraph<Weight>;
+struct SearchScratch {
+    static constexpr EdgeId NO_EDGE = static_cast<EdgeId>(-1);
 
-public:
-    explicit Router(const Graph& graph);
+    struct QueueItem {
+        Weight weight;
+        VertexId vertex;
+
+        bool operator<(const QueueItem& other) const {
+            // инвертировано, чтобы std::push_heap строил min-кучу
+            return other.weight < weight;
+        }
+    };
+
+    std::vector<Weight> weights;
+    std::vector<EdgeId> prev_edges;
+    std::vector<uint32_t> visit_marks;
+    std::vector<QueueItem> heap;
+    uint32_t current_mark = 0;
+
+    void Prepare(size_t vertex_count) {
+        if (visit_marks.size() < vertex_count) {
+            weights.resize(vertex_count);
+            prev_edges.resize(vertex_count);
+            visit_marks.resize(vertex_count, 0);
+        }
+        if (++current_mark == 0) {
+            std::fill(visit_marks.begin(), visit_marks.end(), 0);
+            current_mark = 1;
+        }
+        heap.clear();
+    }
+
+    bool IsReached(VertexId vertex) const {
+        return visit_marks[vertex] == current_mark;
+    }
 
+    // Обновляет вес вершины, если он лучше найденного ранее, и кладет ее в кучу
+    bool Relax(VertexId vertex, Weight weight, EdgeId prev_edge) {
+        if (IsReached(vertex) && !(weight < weights[vertex])) {
+            return false;
+        }
+        weights[vertex] = weight;
+        prev_edges[vertex] = prev_edge;
+        visit_marks[vertex] = current_mark;
+        heap.push_back({weight, vertex});
+        std::push_heap(heap.begin(), heap.end());
+        return true;
+    }
+
+    QueueItem Pop() {
+        std::pop_heap(heap.begin(), heap.end());
+        const QueueItem item = heap.back();
+        heap.pop_back();
+        return item;
+    }
+
+    bool IsStale(const QueueItem& item) const {
+        return weights[item.vertex] < item.weight;
+    }
+};
+
+template <typename Weight>
+class RouterBase {
+public:
     struct RouteInfo {
         Weight weight;
         std::vector<EdgeId> edges;
     };
 
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
+    virtual ~RouterBase() = default;
+
+    virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+
+    // Маршруты из каждой вершины sources в каждую вершину targets, по строкам: маршрут
+    // sources[i] -> targets[j] лежит в [i * targets.size() + j]. Без with_edges у маршрутов
+    // только вес. По умолчанию - BuildRoute на каждую пару, что для таблицы всех пар и есть
+    // чтение таблицы
+    virtual std::vector<std::optional<RouteInfo>> BuildRouteMatrix(const std::vector<VertexId>& sources,
+                                                                   const std::vector<VertexId>& targets, bool with_edges) const {
+        std::vector<std::optional<RouteInfo>> out;
+        out.reserve(sources.size() * targets.size());
+        for (const VertexId from : sources) {
+            for (const VertexId to : targets) {
+                out.push_back(BuildRoute(from, to));
+                if (!with_edges && out.back()) {
+                    out.back()->edges.clear();
+                }
+            }
+        }
+        return out;
+    }
+};
+
+template <typename Weight>
+class Router final : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    // Большая таблица считается в пуле pool вызывающего, без него - в собственном пуле на время расчета.
+    // Пул не должен быть занят другим ParallelFor, пока идет расчет
+    explicit Router(const Graph& graph, thread_pool::ThreadPool* pool = nullptr);
+    // Таблица измененного графа по таблице прежнего: заново считаются только строки, маршруты
+    // которых могли измениться, остальные переносятся с перенумерацией вершин и ребер
+    Router(const Graph& graph, const Router& previous, const GraphMapping& mapping, thread_pool::ThreadPool* pool = nullptr);
+
+    // Пересчет таблицы после изменения весов ребер changed_edges в графе маршрутизатора.
+    // Заново считаются только строки, дерево маршрутов которых проходит через измененное ребро
+    // или может через него сократиться. Не должен идти одновременно с BuildRoute
+    void UpdateEdgeWeights(const std::vector<EdgeId>& changed_edges, thread_pool::ThreadPool* pool = nullptr);
+
+    // Таблица маршрутов всех пар: вес и последнее ребро маршрута from -> to лежат
+    // в ячейке from * vertex_count + to двух плоских массивов
+    struct RoutesInternalData {
+        static constexpr uint32_t NO_ROUTE = std::numeric_limits<uint32_t>::max();
+        static constexpr uint32_t NO_PREV_EDGE = NO_ROUTE - 1;
+
+        size_t vertex_count = 0;
+        std::vector<Weight> weights;
+        std::vector<uint32_t> prev_edges;
     };
 
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+    // Таблица маршрутов без владения: указывает либо в RoutesInternalData, либо во внешнюю память
+    struct RoutesView {
+        size_t vertex_count = 0;
+        const Weight* weights = nullptr;
+        const uint32_t* prev_edges = nullptr;
+    };
 
     struct Data
     {
-        const RoutesInternalData& routes_internal_data;
+        RoutesView routes;
     };
 
+    // Таблица передается либо во владение (routes_internal_data), либо как external_routes,
+    // тогда external_storage удерживает память, в которой она лежит (например, отображенный файл базы)
     struct InitStruct
     {
         RoutesInternalData routes_internal_data;
+        RoutesView external_routes;
+        std::shared_ptr<const void> external_storage;
     };
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
 
     Router(const Graph& graph, Router<Weight>::InitStruct&& init);
 
@@ -55,40 +177,147 @@ private:
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
     RoutesInternalData routes_internal_data_;
+    std::shared_ptr<const void> external_storage_;
+    RoutesView routes_;
+
+    // с какого размера графа фазы алгоритма раздаются пулу потоков
+    static constexpr size_t PARALLEL_VERTEX_COUNT = 256;
+    // ширина блока столбцов, строка vertex_through в его пределах переиспользуется из кэша
+    static constexpr size_t COLUMN_BLOCK_SIZE = 2048;
+    // во сколько раз шаг поиска Дейкстры по строке дороже шага Флойда-Уоршелла
+    static constexpr size_t DIJKSTRA_STEP_COST = 4;
+
+    static SearchScratch<Weight>& GetScratch() {
+        static thread_local SearchScratch<Weight> scratch;
+        return scratch;
+    }
+
+    // Пул для расчета таблицы на vertex_count вершин: nullptr для маленькой таблицы, иначе pool
+    // вызывающего или собственный пул, который own_pool удерживает до конца расчета
+    static thread_pool::ThreadPool* SelectPool(thread_pool::ThreadPool* pool, size_t vertex_count,
+                                               std::unique_ptr<thread_pool::ThreadPool>& own_pool) {
+        if (vertex_count < PARALLEL_VERTEX_COUNT) {
+            return nullptr;
+        }
+        if (pool == nullptr) {
+            own_pool = std::make_unique<thread_pool::ThreadPool>();
+            pool = own_pool.get();
+        }
+        return pool;
+    }
+
+    // Вызывает func(row_begin, row_end) для строк [0, row_count), блоками в пуле потоков, если он есть
+    template <typename Func>
+    static void ForEachRowBlock(thread_pool::ThreadPool* pool, size_t row_count, Func&& func) {
+        if (pool == nullptr) {
+            func(0, row_count);
+            return;
+        }
+        const size_t row_block_size = std::max<size_t>(1, row_count / (pool->GetThreadCount() * 16));
+        pool->ParallelFor(row_count, row_block_size, func);
+    }
 
-    void InitializeRoutesInternalData(const Graph& graph) {
+    static void ResetRoutesInternalData(const Graph& graph, RoutesInternalData& matrix) {
         const size_t vertex_count = graph.GetVertexCount();
+        if (graph.GetEdgeCount() >= RoutesInternalData::NO_PREV_EDGE) {
+            throw std::length_error("Too many edges for the routes table");
+        }
+        if (!graph.IsFrozen()) {
+            throw std::logic_error("Graph should be frozen before routing");
+        }
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+        matrix.vertex_count = vertex_count;
+        matrix.weights.assign(vertex_count * vertex_count, ZERO_WEIGHT);
+        matrix.prev_edges.assign(vertex_count * vertex_count, RoutesInternalData::NO_ROUTE);
+    }
+
+    static void InitializeRoutesInternalData(const Graph& graph, RoutesInternalData& matrix) {
+        ResetRoutesInternalData(graph, matrix);
+        const size_t vertex_count = matrix.vertex_count;
+
         for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
-            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                const auto& edge = graph.GetEdge(edge_id);
-                if (edge.weight < ZERO_WEIGHT) {
-                    throw std::domain_error("Edges' weights should be non-negative");
-                }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+            const size_t row = vertex * vertex_count;
+            matrix.weights[row + vertex] = ZERO_WEIGHT;
+            matrix.prev_edges[row + vertex] = RoutesInternalData::NO_PREV_EDGE;
+            const auto outgoing = graph.GetOutgoingEdges(vertex);
+            for (size_t i = 0; i < outgoing.count; ++i) {
+                const size_t cell = row + outgoing.targets[i];
+                if (matrix.prev_edges[cell] == RoutesInternalData::NO_ROUTE || matrix.weights[cell] > outgoing.weights[i]) {
+                    matrix.weights[cell] = outgoing.weights[i];
+                    matrix.prev_edges[cell] = outgoing.edge_ids[i];
                 }
             }
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                    const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight,
-                              route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    // Строки с is_affected считаются заново поиском Дейкстры, остальные заполняет keep_row(from).
+    // Если пересчитывать пришлось бы слишком много строк, вся таблица строится Флойдом-Уоршеллом
+    template <typename KeepRow>
+    static void RecomputeRows(const Graph& graph, RoutesInternalData& matrix, const std::vector<char>& is_affected,
+                              thread_pool::ThreadPool* pool, KeepRow&& keep_row) {
+        const size_t vertex_count = matrix.vertex_count;
+        const size_t edge_count = graph.GetEdgeCount();
+        const size_t affected_count = static_cast<size_t>(std::count(is_affected.begin(), is_affected.end(), 1));
+
+        // Флойд-Уоршелл стоит V^3 шагов, поиск Дейкстры из одной вершины - порядка (V + E) * log V
+        const double rows_cost = static_cast<double>(affected_count) * static_cast<double>(vertex_count + edge_count)
+                               * std::log2(static_cast<double>(vertex_count) + 2) * DIJKSTRA_STEP_COST;
+        if (rows_cost >= static_cast<double>(vertex_count) * vertex_count * vertex_count) {
+            InitializeRoutesInternalData(graph, matrix);
+            ComputeAllPairs(matrix, pool);
+            return;
         }
+
+        ForEachRowBlock(pool, vertex_count, [&](size_t row_begin, size_t row_end) {
+            for (VertexId from = row_begin; from < row_end; ++from) {
+                if (is_affected[from]) {
+                    ComputeRow(graph, matrix, from);
+                } else {
+                    keep_row(from);
+                }
+            }
+        });
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+    // pool - nullptr для маленькой таблицы, см. SelectPool
+    static void ComputeAllPairs(RoutesInternalData& matrix, thread_pool::ThreadPool* pool);
+    static bool IsRowAffected(const Weight* weights, const uint32_t* prev_edges, size_t vertex_count,
+                              const std::vector<bool>& is_removed_edge, const std::vector<Edge<Weight>>& added_edges);
+    static void CopyPreviousRow(const RoutesView& previous_routes, const GraphMapping& mapping,
+                                const std::vector<VertexId>& previous_vertices, RoutesInternalData& matrix, VertexId from);
+    static void ComputeRow(const Graph& graph, RoutesInternalData& matrix, VertexId from);
+
+    // Фаза vertex_through для строк [row_begin, row_end). Строка и столбец vertex_through
+    // внутри своей фазы не меняются, поэтому строки независимы и порядок их обработки
+    // не влияет на результат - он совпадает с последовательным алгоритмом
+    static void RelaxRowsThroughVertex(RoutesInternalData& matrix, VertexId vertex_through, size_t row_begin, size_t row_end) {
+        const size_t vertex_count = matrix.vertex_count;
+        const size_t row_through = vertex_through * vertex_count;
+
+        for (size_t column_begin = 0; column_begin < vertex_count; column_begin += COLUMN_BLOCK_SIZE) {
+            const size_t column_end = std::min(vertex_count, column_begin + COLUMN_BLOCK_SIZE);
+            for (VertexId vertex_from = row_begin; vertex_from < row_end; ++vertex_from) {
+                const size_t row_from = vertex_from * vertex_count;
+                const uint32_t prev_edge_from = matrix.prev_edges[row_from + vertex_through];
+                if (prev_edge_from == RoutesInternalData::NO_ROUTE) {
+                    continue;
+                }
+                const Weight weight_from = matrix.weights[row_from + vertex_through];
+
+                for (VertexId vertex_to = column_begin; vertex_to < column_end; ++vertex_to) {
+                    const uint32_t prev_edge_to = matrix.prev_edges[row_through + vertex_to];
+                    if (prev_edge_to == RoutesInternalData::NO_ROUTE) {
+                        continue;
+                    }
+                    const size_t cell = row_from + vertex_to;
+                    const Weight candidate_weight = weight_from + matrix.weights[row_through + vertex_to];
+                    if (matrix.prev_edges[cell] == RoutesInternalData::NO_ROUTE || candidate_weight < matrix.weights[cell]) {
+                        matrix.weights[cell] = candidate_weight;
+                        matrix.prev_edges[cell] = prev_edge_to != RoutesInternalData::NO_PREV_EDGE ? prev_edge_to : prev_edge_from;
                     }
                 }
             }
@@ -97,36 +326,254 @@ private:
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+Router<Weight>::Router(const Graph& graph, thread_pool::ThreadPool* pool)
+    : graph_(graph)
+{
+    RoutesInternalData& matrix = routes_internal_data_;
+    InitializeRoutesInternalData(graph, matrix);
+    std::unique_ptr<thread_pool::ThreadPool> own_pool;
+    ComputeAllPairs(matrix, SelectPool(pool, matrix.vertex_count, own_pool));
+
+    routes_ = {matrix.vertex_count, matrix.weights.data(), matrix.prev_edges.data()};
+}
+
+template <typename Weight>
+void Router<Weight>::ComputeAllPairs(RoutesInternalData& matrix, thread_pool::ThreadPool* pool) {
+    const size_t vertex_count = matrix.vertex_count;
+    if (pool == nullptr) {
+        for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
+            RelaxRowsThroughVertex(matrix, vertex_through, 0, vertex_count);
+        }
+    } else {
+        const size_t row_block_size = std::max<size_t>(1, vertex_count / (pool->GetThreadCount() * 4));
+        for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
+            pool->ParallelFor(vertex_count, row_block_size, [&matrix, vertex_through](size_t row_begin, size_t row_end) {
+                RelaxRowsThroughVertex(matrix, vertex_through, row_begin, row_end);
+            });
+        }
+    }
+}
+
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, const Router& previous, const GraphMapping& mapping, thread_pool::ThreadPool* pool)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
 {
-    InitializeRoutesInternalData(graph);
+    const RoutesView& previous_routes = previous.routes_;
+    if (mapping.vertices.size() != previous_routes.vertex_count || mapping.edges.size() != previous.graph_.GetEdgeCount()) {
+        throw std::invalid_argument("Graph mapping does not match the routes table");
+    }
 
     const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    const size_t edge_count = graph.GetEdgeCount();
+
+    std::vector<VertexId> previous_vertices(vertex_count, GraphMapping::NO_VERTEX);
+    for (VertexId vertex = 0; vertex < mapping.vertices.size(); ++vertex) {
+        if (mapping.vertices[vertex] != GraphMapping::NO_VERTEX) {
+            previous_vertices.at(mapping.vertices[vertex]) = vertex;
+        }
     }
+
+    // удаленные ребра - в нумерации прежнего графа, добавленные - с концами в нумерации прежнего графа
+    std::vector<bool> is_removed_edge(mapping.edges.size(), false);
+    std::vector<bool> is_mapped_edge(edge_count, false);
+    for (EdgeId edge_id = 0; edge_id < mapping.edges.size(); ++edge_id) {
+        if (mapping.edges[edge_id] == GraphMapping::NO_EDGE) {
+            is_removed_edge[edge_id] = true;
+        } else {
+            is_mapped_edge.at(mapping.edges[edge_id]) = true;
+        }
+    }
+    std::vector<Edge<Weight>> added_edges;
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (!is_mapped_edge[edge_id]) {
+            const auto& edge = graph.GetEdge(edge_id);
+            added_edges.push_back({previous_vertices[edge.from], previous_vertices[edge.to], edge.weight});
+        }
+    }
+
+    std::unique_ptr<thread_pool::ThreadPool> own_pool;
+    pool = SelectPool(pool, vertex_count, own_pool);
+
+    const size_t previous_count = previous_routes.vertex_count;
+    std::vector<char> is_affected(vertex_count, 0);
+    ForEachRowBlock(pool, vertex_count, [&](size_t row_begin, size_t row_end) {
+        for (VertexId from = row_begin; from < row_end; ++from) {
+            const size_t previous_row = previous_vertices[from] * previous_count;
+            is_affected[from] = previous_vertices[from] == GraphMapping::NO_VERTEX
+                              || IsRowAffected(previous_routes.weights + previous_row, previous_routes.prev_edges + previous_row,
+                                               previous_count, is_removed_edge, added_edges);
+        }
+    });
+
+    RoutesInternalData& matrix = routes_internal_data_;
+    ResetRoutesInternalData(graph, matrix);
+    RecomputeRows(graph, matrix, is_affected, pool, [&](VertexId from) {
+        CopyPreviousRow(previous_routes, mapping, previous_vertices, matrix, from);
+    });
+
+    routes_ = {matrix.vertex_count, matrix.weights.data(), matrix.prev_edges.data()};
 }
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph, Router<Weight>::InitStruct&& init): graph_(graph), routes_internal_data_(std::move(init.routes_internal_data)) {}
+void Router<Weight>::UpdateEdgeWeights(const std::vector<EdgeId>& changed_edges, thread_pool::ThreadPool* pool) {
+    RoutesInternalData& matrix = routes_internal_data_;
+    if (external_storage_) {
+        // таблица во внешней памяти только для чтения, дальше маршрутизатор владеет своей копией
+        const size_t cell_count = routes_.vertex_count * routes_.vertex_count;
+        matrix.vertex_count = routes_.vertex_count;
+        matrix.weights.assign(routes_.weights, routes_.weights + cell_count);
+        matrix.prev_edges.assign(routes_.prev_edges, routes_.prev_edges + cell_count);
+        external_storage_.reset();
+    }
+
+    std::vector<bool> is_changed_edge(graph_.GetEdgeCount(), false);
+    std::vector<Edge<Weight>> changed;
+    changed.reserve(changed_edges.size());
+    for (const EdgeId edge_id : changed_edges) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        is_changed_edge[edge_id] = true;
+        changed.push_back(edge);
+    }
+
+    const size_t vertex_count = matrix.vertex_count;
+    std::unique_ptr<thread_pool::ThreadPool> own_pool;
+    pool = SelectPool(pool, vertex_count, own_pool);
+
+    // измененное ребро считается удаленным со старым весом и добавленным с новым
+    std::vector<char> is_affected(vertex_count, 0);
+    ForEachRowBlock(pool, vertex_count, [&](size_t row_begin, size_t row_end) {
+        for (VertexId from = row_begin; from < row_end; ++from) {
+            const size_t row = from * vertex_count;
+            is_affected[from] = IsRowAffected(matrix.weights.data() + row, matrix.prev_edges.data() + row,
+                                              vertex_count, is_changed_edge, changed);
+        }
+    });
+
+    RecomputeRows(graph_, matrix, is_affected, pool, [](VertexId) {});
+
+    routes_ = {matrix.vertex_count, matrix.weights.data(), matrix.prev_edges.data()};
+}
+
+// Строка остается верной, если ее дерево кратчайших маршрутов не использует удаленных ребер
+// и ни одно добавленное ребро (u, v) не сокращает маршрут: d(u) + w >= d(v). Тогда расстояния строки
+// остаются допустимым потенциалом для нового графа и не могут уменьшиться.
+// Концы добавленных ребер - в нумерации строки, NO_VERTEX - вершины в ней нет
+template <typename Weight>
+bool Router<Weight>::IsRowAffected(const Weight* weights, const uint32_t* prev_edges, size_t vertex_count,
+                                   const std::vector<bool>& is_removed_edge, const std::vector<Edge<Weight>>& added_edges) {
+    for (size_t vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
+        const uint32_t prev_edge = prev_edges[vertex_to];
+        if (prev_edge < RoutesInternalData::NO_PREV_EDGE && is_removed_edge[prev_edge]) {
+            return true;
+        }
+    }
+
+    for (const auto& edge : added_edges) {
+        if (edge.from == GraphMapping::NO_VERTEX || prev_edges[edge.from] == RoutesInternalData::NO_ROUTE) {
+            continue;
+        }
+        if (edge.to == GraphMapping::NO_VERTEX || prev_edges[edge.to] == RoutesInternalData::NO_ROUTE
+            || weights[edge.from] + edge.weight < weights[edge.to]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Weight>
+void Router<Weight>::CopyPreviousRow(const RoutesView& previous_routes, const GraphMapping& mapping,
+                                     const std::vector<VertexId>& previous_vertices, RoutesInternalData& matrix, VertexId from) {
+    const size_t vertex_count = matrix.vertex_count;
+    const size_t previous_count = previous_routes.vertex_count;
+    const size_t previous_row = previous_vertices[from] * previous_count;
+    const size_t row = from * vertex_count;
+
+    for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
+        const VertexId previous_to = previous_vertices[vertex_to];
+        if (previous_to == GraphMapping::NO_VERTEX) {
+            matrix.weights[row + vertex_to] = ZERO_WEIGHT;
+            matrix.prev_edges[row + vertex_to] = RoutesInternalData::NO_ROUTE;
+            continue;
+        }
+        const uint32_t prev_edge = previous_routes.prev_edges[previous_row + previous_to];
+        matrix.weights[row + vertex_to] = previous_routes.weights[previous_row + previous_to];
+        matrix.prev_edges[row + vertex_to] = prev_edge < RoutesInternalData::NO_PREV_EDGE
+                                           ? static_cast<uint32_t>(mapping.edges[prev_edge]) : prev_edge;
+    }
+}
+
+// Строка таблицы поиском Дейкстры из вершины from: последние ребра маршрутов образуют
+// дерево кратчайших путей, как и в таблице Флойда-Уоршелла
+template <typename Weight>
+void Router<Weight>::ComputeRow(const Graph& graph, RoutesInternalData& matrix, VertexId from) {
+    using ScratchData = SearchScratch<Weight>;
+    const size_t vertex_count = matrix.vertex_count;
+    ScratchData& scratch = GetScratch();
+    scratch.Prepare(vertex_count);
+
+    scratch.Relax(from, ZERO_WEIGHT, ScratchData::NO_EDGE);
+    while (!scratch.heap.empty()) {
+        const auto item = scratch.Pop();
+        if (scratch.IsStale(item)) {
+            continue;
+        }
+        const auto outgoing = graph.GetOutgoingEdges(item.vertex);
+        for (size_t i = 0; i < outgoing.count; ++i) {
+            scratch.Relax(outgoing.targets[i], item.weight + outgoing.weights[i], outgoing.edge_ids[i]);
+        }
+    }
+
+    const size_t row = from * vertex_count;
+    for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
+        if (!scratch.IsReached(vertex_to)) {
+            matrix.weights[row + vertex_to] = ZERO_WEIGHT;
+            matrix.prev_edges[row + vertex_to] = RoutesInternalData::NO_ROUTE;
+        } else {
+            matrix.weights[row + vertex_to] = scratch.weights[vertex_to];
+            matrix.prev_edges[row + vertex_to] = vertex_to == from
+                                               ? RoutesInternalData::NO_PREV_EDGE : static_cast<uint32_t>(scratch.prev_edges[vertex_to]);
+        }
+    }
+}
+
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, Router<Weight>::InitStruct&& init)
+    : graph_(graph)
+    , routes_internal_data_(std::move(init.routes_internal_data))
+    , external_storage_(std::move(init.external_storage))
+{
+    if (external_storage_) {
+        routes_ = init.external_routes;
+    } else {
+        routes_ = {routes_internal_data_.vertex_count, routes_internal_data_.weights.data(), routes_internal_data_.prev_edges.data()};
+    }
+    if (routes_.vertex_count != graph.GetVertexCount()) {
+        throw std::invalid_argument("Routes table does not match the graph");
+    }
+}
 
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
+    const size_t vertex_count = routes_.vertex_count;
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const size_t row_from = from * vertex_count;
+    const uint32_t* prev_edges = routes_.prev_edges + row_from;
+    if (prev_edges[to] == RoutesInternalData::NO_ROUTE) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
+    const Weight weight = routes_.weights[row_from + to];
     std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+    for (uint32_t edge_id = prev_edges[to];
+         edge_id != RoutesInternalData::NO_PREV_EDGE;
+         edge_id = prev_edges[graph_.GetEdge(edge_id).from])
     {
-        edges.push_back(*edge_id);
+        edges.push_back(edge_id);
     }
     std::reverse(edges.begin(), edges.end());
 
@@ -136,7 +583,7 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
 template <typename Weight>
 typename Router<Weight>::Data Router<Weight>::GetData() const
 {
-    return {routes_internal_data_};
+    return {routes_};
 }
 
 }  // namespace graph
\ No newline at end of file
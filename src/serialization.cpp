@@ -1,8 +1,140 @@
 #include "serialization.h"
 
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
 namespace NS_TransportCatalogue::Serealization_Worker
 {
 
+namespace
+{
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool IS_LITTLE_ENDIAN = false;
+#else
+constexpr bool IS_LITTLE_ENDIAN = true;
+#endif
+
+// Массив значений фиксированной ширины в байты little-endian, на little-endian машинах одним memcpy
+template <typename Value>
+void WritePacked(const Value* values, size_t count, std::string* out)
+{
+    static_assert(std::is_trivially_copyable_v<Value>);
+
+    out->resize(count * sizeof(Value));
+    if (count == 0)
+    {
+        return;
+    }
+
+    std::memcpy(out->data(), values, out->size());
+    if constexpr (!IS_LITTLE_ENDIAN)
+    {
+        for (auto it = out->begin(); it != out->end(); it += sizeof(Value))
+        {
+            std::reverse(it, it + sizeof(Value));
+        }
+    }
+}
+
+template <typename Value>
+void ReadPacked(const std::string& in, std::vector<Value>& values)
+{
+    static_assert(std::is_trivially_copyable_v<Value>);
+
+    if (in.size() != values.size() * sizeof(Value))
+    {
+        throw std::invalid_argument("deserialization error: packed array size mismatch");
+    }
+    if (values.empty())
+    {
+        return;
+    }
+
+    std::memcpy(values.data(), in.data(), in.size());
+    if constexpr (!IS_LITTLE_ENDIAN)
+    {
+        auto* bytes = reinterpret_cast<char*>(values.data());
+        for (size_t offset = 0; offset < in.size(); offset += sizeof(Value))
+        {
+            std::reverse(bytes + offset, bytes + offset + sizeof(Value));
+        }
+    }
+}
+
+// Таблица баз прежних версий: строка на вершину, ячейка без data - маршрута нет,
+// ячейка без prev_edge - маршрут из вершины в нее саму
+void ReadLegacyRoutes(const transport_catalogue_serialize::Router& proto_router,
+    graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>::RoutesInternalData& routes_data)
+{
+    using RoutesInternalData = graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>::RoutesInternalData;
+
+    const size_t vertex_count = static_cast<size_t>(proto_router.routes_data_size());
+    routes_data.vertex_count = vertex_count;
+    routes_data.weights.assign(vertex_count * vertex_count, {});
+    routes_data.prev_edges.assign(vertex_count * vertex_count, RoutesInternalData::NO_ROUTE);
+
+    for (size_t from = 0; from < vertex_count; ++from)
+    {
+        const auto& row = proto_router.routes_data(static_cast<int>(from)).data_list();
+        if (static_cast<size_t>(row.size()) != vertex_count)
+        {
+            throw std::invalid_argument("deserialization error: broken routes table row");
+        }
+        for (size_t to = 0; to < vertex_count; ++to)
+        {
+            const auto& cell = row[static_cast<int>(to)];
+            if (!cell.has_data())
+            {
+                continue;
+            }
+            routes_data.weights[from * vertex_count + to] = {cell.data().weight()};
+            if (!cell.data().has_prev_edge())
+            {
+                routes_data.prev_edges[from * vertex_count + to] = RoutesInternalData::NO_PREV_EDGE;
+                continue;
+            }
+            const uint64_t prev_edge = cell.data().prev_edge().data();
+            if (prev_edge >= RoutesInternalData::NO_PREV_EDGE)
+            {
+                throw std::invalid_argument("deserialization error: routes table edge is out of range");
+            }
+            routes_data.prev_edges[from * vertex_count + to] = static_cast<uint32_t>(prev_edge);
+        }
+    }
+}
+
+} // end namespace
+
+transport_catalogue_serialize::ContractionHierarchies Serealization::CreateProtoContractionHierarchies() const
+{
+    transport_catalogue_serialize::ContractionHierarchies out;
+
+    auto ch_data = ch_router_ptr_->GetData();
+
+    for (const auto rank : ch_data.ranks)
+    {
+        out.add_ranks(rank);
+    }
+
+    for (const auto& shortcut : ch_data.shortcuts)
+    {
+        transport_catalogue_serialize::ContractionHierarchies::Shortcut proto_shortcut;
+
+        proto_shortcut.set_from(shortcut.from);
+        proto_shortcut.set_to(shortcut.to);
+        proto_shortcut.set_weight(shortcut.weight.weight);
+        proto_shortcut.set_first_edge(shortcut.first_edge);
+        proto_shortcut.set_second_edge(shortcut.second_edge);
+
+        *out.add_shortcuts() = std::move(proto_shortcut);
+    }
+
+    return out;
+}
+
 // ======Class Serealization===========
 
 Serealization::Serealization(const NS_TransportCatalogue::TransportCatalogue& catalog): NS_TransportCatalogue::DB_Worker(catalog), fields_(GetSerealizFields()) {}
@@ -12,15 +144,33 @@ void Serealization::RunSerealization(std::ostream& output)
     CreateProtoTransportCatalogue().SerializePartialToOstream(&output);
 }
 
-transport_catalogue_serialize::TransportCatalogue Serealization::CreateProtoTransportCatalogue() const
+void Serealization::RunSerealizationImage(std::ostream& output)
+{
+    using RouterWeight = TransportCatalogue_Router::GraphBuilder::RouterWeight;
+    static_assert(sizeof(RouterWeight) == sizeof(double) && std::is_standard_layout_v<RouterWeight>);
+
+    std::string catalogue;
+    CreateProtoTransportCatalogue(false).SerializePartialToString(&catalogue);
+
+    if (graph_builder_ptr_ && router_ptr_)
+    {
+        const auto routes = router_ptr_->GetData().routes;
+        const BaseImageRoutes image_routes{routes.vertex_count, reinterpret_cast<const double*>(routes.weights), routes.prev_edges};
+        WriteBaseImage(output, catalogue, &image_routes);
+    }
+    else
+    {
+        WriteBaseImage(output, catalogue, nullptr);
+    }
+}
+
+transport_catalogue_serialize::TransportCatalogue Serealization::CreateProtoTransportCatalogue(bool with_routes_table) const
 {
     transport_catalogue_serialize::TransportCatalogue out;
 
     auto stop_iter = fields_.stops_base_.cbegin();
     auto bus_iter = fields_.bus_base_.cbegin();
-    auto length_iter = fields_.length_stop_to_neighbor_.cbegin();
-
-    for (size_t i = 0; i < std::max({fields_.stops_base_.size(), fields_.bus_base_.size(), fields_.length_stop_to_neighbor_.size()}); ++i)
+    for (size_t i = 0; i < std::max(fields_.stops_base_.size(), fields_.bus_base_.size()); ++i)
     {
         if (i < fields_.stops_base_.size())
         {
@@ -37,26 +187,37 @@ transport_catalogue_serialize::TransportCatalogue Serealization::CreateProtoTran
 
             ++bus_iter;
         }
-
-        if (i < fields_.length_stop_to_neighbor_.size())
-        {
-
-            *out.add_length_btw_stops() = CreateProtoStopToStop(length_iter->first.first, length_iter->first.second, length_iter->second);
-
-            ++length_iter;
-        }
     }
 
+    fields_.length_stop_to_neighbor_.ForEach([this, &out](size_t from, size_t to, unsigned int length)
+    {
+        *out.add_length_btw_stops() = CreateProtoStopToStop(from, to, length);
+    });
+
     if (map_settings_)
     {
         *out.mutable_render_settings() = CreateProtoRenderSettings();
     }
 
-    if (graph_builder_ptr_ && router_ptr_)
+    // в режиме RAPTOR графа нет, маршруты ищутся по каталогу, хранятся только настройки
+    if (router_settings_ && router_settings_->mode == TransportCatalogue_Router::RouterMode::RAPTOR)
+    {
+        *out.mutable_router_settings() = CreateProtoRouterSettings(*router_settings_);
+    }
+    else if (graph_builder_ptr_)
     {
         *out.mutable_router_settings() = CreateProtoRouterSettings(*router_settings_);
         *out.mutable_route_builder() = CreateProtoGraphBuilder();
-        *out.mutable_router() = CreateProtoRouter();
+
+        if (router_ptr_ && with_routes_table)
+        {
+            *out.mutable_router() = CreateProtoRouter();
+        }
+
+        if (ch_router_ptr_)
+        {
+            *out.mutable_contraction_hierarchies() = CreateProtoContractionHierarchies();
+        }
     }
 
     return out;
@@ -67,7 +228,7 @@ transport_catalogue_serialize::Stop Serealization::CreateProtoStop(const domain:
     transport_catalogue_serialize::Stop out;
 
     out.set_id(stop.id);
-    out.set_name(stop.name);
+    out.set_name(stop.name.data(), stop.name.size());
 
     transport_catalogue_serialize::Geo coordinates;
 
@@ -84,7 +245,7 @@ transport_catalogue_serialize::Bus Serealization::CreateProtoBus(const domain::B
     transport_catalogue_serialize::Bus out;
 
     out.set_id(bus.id);
-    out.set_name(bus.name);
+    out.set_name(bus.name.data(), bus.name.size());
     
     for (const auto& stop : bus.stops)
     {
@@ -100,15 +261,22 @@ transport_catalogue_serialize::Bus Serealization::CreateProtoBus(const domain::B
         out.set_root_type(transport_catalogue_serialize::Root_Type::FORWARD);
     }
 
+    transport_catalogue_serialize::BusStats* stats = out.mutable_stats();
+    stats->set_route_length(bus.stats.route_length);
+    stats->set_distance(bus.stats.distance);
+    stats->set_curvature(bus.stats.curvature);
+    stats->set_stop_count(bus.stats.stop_count);
+    stats->set_unique_stop_count(bus.stats.unique_stop_count);
+
     return out;
 }
 
-transport_catalogue_serialize::StopToStop Serealization::CreateProtoStopToStop(const domain::Stop* from, const domain::Stop* to, unsigned int lenght) const
+transport_catalogue_serialize::StopToStop Serealization::CreateProtoStopToStop(size_t from_id, size_t to_id, unsigned int lenght) const
 {
     transport_catalogue_serialize::StopToStop out;
 
-    out.set_id_from(from->id);
-    out.set_id_to(to->id);
+    out.set_id_from(from_id);
+    out.set_id_to(to_id);
     out.set_length(lenght);
 
     return out;
@@ -211,6 +379,11 @@ void Serealization::SetRouter(const graph::Router<TransportCatalogue_Router::Gra
     router_ptr_ = router;
 }
 
+void Serealization::SetContractionHierarchies(const CHRouter* ch_router)
+{
+    ch_router_ptr_ = ch_router;
+}
+
 transport_catalogue_serialize::RouterSettings Serealization::CreateProtoRouterSettings(TransportCatalogue_Router::RouterSettings settings) const
 {
     transport_catalogue_serialize::RouterSettings out;
@@ -218,6 +391,28 @@ transport_catalogue_serialize::RouterSettings Serealization::CreateProtoRouterSe
     out.set_bus_speed(settings.bus_speed);
     out.set_bus_wait_time(settings.bus_wait_time);
 
+    if (settings.mode == TransportCatalogue_Router::RouterMode::DIJKSTRA)
+    {
+        out.set_mode(transport_catalogue_serialize::Router_Mode::DIJKSTRA);
+    }
+    else if (settings.mode == TransportCatalogue_Router::RouterMode::CONTRACTION_HIERARCHIES)
+    {
+        out.set_mode(transport_catalogue_serialize::Router_Mode::CONTRACTION_HIERARCHIES);
+    }
+    else if (settings.mode == TransportCatalogue_Router::RouterMode::RAPTOR)
+    {
+        out.set_mode(transport_catalogue_serialize::Router_Mode::RAPTOR);
+    }
+    else
+    {
+        out.set_mode(transport_catalogue_serialize::Router_Mode::ALL_PAIRS);
+    }
+
+    if (settings.graph_model == TransportCatalogue_Router::GraphModel::LINEAR)
+    {
+        out.set_graph_model(transport_catalogue_serialize::Graph_Model::LINEAR);
+    }
+
     return out;
 }
 
@@ -226,35 +421,15 @@ transport_catalogue_serialize::DirectedWeightedGraph Serealization::CreateProtoD
     transport_catalogue_serialize::DirectedWeightedGraph out;
 
     auto graph_data = graph.GetData();
+    out.set_vertex_count(graph_data.vertex_count);
 
-    auto edge_iter = graph_data.edges.cbegin();
-    auto incid_list_iter = graph_data.incident_lists.cbegin();
-    for (size_t i = 0; i < std::max({graph_data.edges.size(), graph_data.incident_lists.size()}); ++i)
+    out.mutable_edges()->Reserve(static_cast<int>(graph_data.edges.size()));
+    for (const auto& edge : graph_data.edges)
     {
-        if (i < graph_data.edges.size())
-        {
-            transport_catalogue_serialize::DirectedWeightedGraph::Edge edge_in;
-            edge_in.set_from(edge_iter->from);
-            edge_in.set_to(edge_iter->to);
-            edge_in.set_weight(edge_iter->weight.weight);
-
-            *out.add_edges() = edge_in;
-
-            ++edge_iter;
-        }
-
-        if (i < graph_data.incident_lists.size())
-        {
-            transport_catalogue_serialize::DirectedWeightedGraph::IncidenceList il_proto;
-            for (const auto il : *incid_list_iter)
-            {
-                il_proto.add_edge_id_list(il);
-            }
-
-            *out.add_incidence_lists() = std::move(il_proto);
-
-            ++incid_list_iter;
-        }
+        transport_catalogue_serialize::DirectedWeightedGraph::Edge* edge_in = out.add_edges();
+        edge_in->set_from(edge.from);
+        edge_in->set_to(edge.to);
+        edge_in->set_weight(edge.weight.weight);
     }
 
     return out;
@@ -268,15 +443,12 @@ transport_catalogue_serialize::GraphBuilder Serealization::CreateProtoGraphBuild
 
     *out.mutable_graph() = CreateProtoDWGraph(graph_builder_data.graph);
 
+    out.mutable_edge_owner_ids()->Reserve(static_cast<int>(graph_builder_data.edgels.size()));
+    out.mutable_edge_span_counts()->Reserve(static_cast<int>(graph_builder_data.edgels.size()));
     for (const auto& edge_id : graph_builder_data.edgels)
     {
-        transport_catalogue_serialize::GraphBuilder::EdgeID proto_edge_id;
-        
-        proto_edge_id.set_name(edge_id.name.data());
-        proto_edge_id.set_span_count(edge_id.span_count);
-        proto_edge_id.set_weight(edge_id.weight);
-
-        *out.add_edgels() = std::move(proto_edge_id);
+        out.add_edge_owner_ids(edge_id.owner_id);
+        out.add_edge_span_counts(edge_id.span_count);
     }
 
     return out;
@@ -284,40 +456,16 @@ transport_catalogue_serialize::GraphBuilder Serealization::CreateProtoGraphBuild
 
 transport_catalogue_serialize::Router Serealization::CreateProtoRouter() const
 {
-    transport_catalogue_serialize::Router out;
+    static_assert(sizeof(TransportCatalogue_Router::GraphBuilder::RouterWeight) == sizeof(double));
 
-    auto router_data = router_ptr_->GetData();
-
-    for (const auto& elemtnt_extermal_arr : router_data.routes_internal_data)
-    {
-        transport_catalogue_serialize::Router::RouterIternalData proto_rout_data;
-
-        for (const auto& elemtnt_iternal_arr : elemtnt_extermal_arr)
-        {
-            transport_catalogue_serialize::Router::RouterIternalData::OptRouterData opt_data;
-            
-            if (elemtnt_iternal_arr)
-            {
-                transport_catalogue_serialize::Router::RouterIternalData::OptRouterData::RouterData data;
-
-                data.set_weight(elemtnt_iternal_arr->weight.weight);
+    transport_catalogue_serialize::Router out;
 
-                if (elemtnt_iternal_arr->prev_edge)
-                {
-                    transport_catalogue_serialize::Router::RouterIternalData::OptRouterData::RouterData::Prev_Edge prev_edge;
-                    prev_edge.set_data(*elemtnt_iternal_arr->prev_edge);
-                    
-                    *data.mutable_prev_edge() = prev_edge;
-                }
+    const auto routes = router_ptr_->GetData().routes;
+    const size_t cell_count = routes.vertex_count * routes.vertex_count;
 
-                *opt_data.mutable_data() = data;
-            }
-
-            *proto_rout_data.add_data_list() = opt_data;
-        }
-
-        *out.add_routes_data() = proto_rout_data;
-    }
+    out.set_vertex_count(routes.vertex_count);
+    WritePacked(routes.weights, cell_count, out.mutable_weights());
+    WritePacked(routes.prev_edges, cell_count, out.mutable_prev_edges());
 
     return out;
 }
@@ -343,16 +491,65 @@ void Deserealization::RunDeserealization(std::istream& input)
 void Deserealization::RunDeserealization(std::istream& input, Interfaces::JsonReader& reader)
 {
     RunDeserealization(input);
+    FeedReader(reader);
+}
+
+void Deserealization::RunDeserealization(const Path& file, Interfaces::JsonReader& reader)
+{
+    mapped_file_ = std::make_shared<const MappedFile>(file);
+
+    const char* data = mapped_file_->GetData();
+    const size_t size = mapped_file_->GetSize();
+
+    std::string_view catalogue(data, size);
+    if (IsBaseImage(data, size))
+    {
+        const BaseImage image = ReadBaseImage(data, size);
+        catalogue = image.catalogue;
+        if (image.has_routes)
+        {
+            image_routes_ = image.routes;
+        }
+    }
+
+    if (!desed_catalog_.ParseFromArray(catalogue.data(), static_cast<int>(catalogue.size())))
+    {
+        throw std::runtime_error("can't parse file - " + file.string());
+    }
+    FeedTCFieds();
+    FeedReader(reader);
+}
 
+void Deserealization::FeedReader(Interfaces::JsonReader& reader)
+{
     if (desed_catalog_.has_render_settings())
     {
         reader.SetMapReanderSettings(CreateMapRenderSettings(*desed_catalog_.mutable_render_settings()));
     }
     
-    if (desed_catalog_.has_route_builder() && desed_catalog_.has_router())
+    if (desed_catalog_.has_router_settings())
     {
         reader.SetRouterSettings(CreateRouterSettings(desed_catalog_.mutable_router_settings()));
-        reader.InitRouter(CreateGraphBuilderInit(CreateRouterSettings(desed_catalog_.mutable_router_settings()), desed_catalog_.mutable_route_builder()), CreateRouterInit(desed_catalog_.mutable_router()));
+    }
+
+    if (desed_catalog_.has_route_builder())
+    {
+        if (desed_catalog_.has_contraction_hierarchies())
+        {
+            reader.InitRouter(CreateGraphBuilderInit(CreateRouterSettings(desed_catalog_.mutable_router_settings()), desed_catalog_.mutable_route_builder()), CreateContractionHierarchiesInit(desed_catalog_.mutable_contraction_hierarchies()));
+        }
+        else if (image_routes_)
+        {
+            reader.InitRouter(CreateGraphBuilderInit(CreateRouterSettings(desed_catalog_.mutable_router_settings()), desed_catalog_.mutable_route_builder()), CreateRouterInit(*image_routes_));
+        }
+        else if (desed_catalog_.has_router())
+        {
+            reader.InitRouter(CreateGraphBuilderInit(CreateRouterSettings(desed_catalog_.mutable_router_settings()), desed_catalog_.mutable_route_builder()), CreateRouterInit(desed_catalog_.mutable_router()));
+        }
+        else
+        {
+            reader.InitRouter(CreateGraphBuilderInit(CreateRouterSettings(desed_catalog_.mutable_router_settings()), desed_catalog_.mutable_route_builder()));
+        }
     }
 }
 
@@ -377,7 +574,7 @@ std::vector<domain::Stop*> Deserealization::FeedStops(google::protobuf::Repeated
     {
         domain::Stop stop
         {
-            std::move(*stops_arr->Mutable(i)->mutable_name()),
+            fields_.names_.Intern(stops_arr->Get(i).name()),
             {stops_arr->Mutable(i)->coordinates().lat(), stops_arr->Mutable(i)->coordinates().lng()},
         };
         stop.id = stops_arr->Mutable(i)->id();
@@ -402,7 +599,7 @@ void Deserealization::FeedBus(transport_catalogue_serialize::Bus* bus_in, const
 
         domain::Bus& bus = fields_.bus_base_.emplace_back();
 
-        bus.name =  std::move(*bus_in->mutable_name());
+        bus.name = fields_.names_.Intern(bus_in->name());
         bus.id = bus_in->id();
 
         if (bus_in->root_type() == transport_catalogue_serialize::Root_Type::CYCLE)
@@ -424,22 +621,23 @@ void Deserealization::FeedBus(transport_catalogue_serialize::Bus* bus_in, const
             fields_.bus_throw_stop_[bus.stops.back()].insert(bus.name);
         }
 
+        if (bus_in->has_stats())
+        {
+            const auto& stats = bus_in->stats();
+            bus.stats = {stats.route_length(), stats.distance(), stats.curvature(), stats.stop_count(), stats.unique_stop_count()};
+        }
+
         fields_.bus_index_table_[fields_.bus_base_.back().name] = &fields_.bus_base_.back();
 }
 
 void Deserealization::FeedLength(transport_catalogue_serialize::StopToStop* proto_st_to_st, const std::vector<domain::Stop*>& stops_id_index)
 {
-    fields_.length_stop_to_neighbor_.insert(
-        std::make_pair(
-            std::make_pair(stops_id_index[proto_st_to_st->id_from()], stops_id_index[proto_st_to_st->id_to()]),
-            proto_st_to_st->length()
-        )
-    );
+    fields_.length_stop_to_neighbor_.Insert(stops_id_index[proto_st_to_st->id_from()]->id, stops_id_index[proto_st_to_st->id_to()]->id, proto_st_to_st->length());
 }
 
 void Deserealization::FeedFields(google::protobuf::RepeatedPtrField<transport_catalogue_serialize::Bus>* bus_arr, google::protobuf::RepeatedPtrField<transport_catalogue_serialize::StopToStop>* length_arr, std::vector<domain::Stop*>&& stops_id_index)
 {
-    fields_.length_stop_to_neighbor_.reserve(length_arr->size());
+    fields_.length_stop_to_neighbor_.Reserve(length_arr->size());
     fields_.bus_index_table_.reserve(bus_arr->size());
 
     for (int i = 0; i < std::max({bus_arr->size(), length_arr->size()}); ++i)
@@ -454,6 +652,23 @@ void Deserealization::FeedFields(google::protobuf::RepeatedPtrField<transport_ca
             FeedLength(length_arr->Mutable(i), stops_id_index);
         }
     }
+
+    // длины перегонов, а в базах без сохраненных показателей и они, считаются после загрузки всех расстояний
+    for (auto& bus : fields_.bus_base_)
+    {
+        UpdateHopLengths(bus);
+    }
+    for (int i = 0; i < bus_arr->size(); ++i)
+    {
+        if (!bus_arr->Get(i).has_stats())
+        {
+            for (auto& bus : fields_.bus_base_)
+            {
+                UpdateBusStats(bus);
+            }
+            break;
+        }
+    }
 }
 
 Interfaces::MapRenderer::RenderSetting Deserealization::CreateMapRenderSettings(transport_catalogue_serialize::RenderSettings& settings)
@@ -523,6 +738,28 @@ TransportCatalogue_Router::RouterSettings Deserealization::CreateRouterSettings(
     out.bus_speed = settings->bus_speed();
     out.bus_wait_time = settings->bus_wait_time();
 
+    if (settings->mode() == transport_catalogue_serialize::Router_Mode::DIJKSTRA)
+    {
+        out.mode = TransportCatalogue_Router::RouterMode::DIJKSTRA;
+    }
+    else if (settings->mode() == transport_catalogue_serialize::Router_Mode::CONTRACTION_HIERARCHIES)
+    {
+        out.mode = TransportCatalogue_Router::RouterMode::CONTRACTION_HIERARCHIES;
+    }
+    else if (settings->mode() == transport_catalogue_serialize::Router_Mode::RAPTOR)
+    {
+        out.mode = TransportCatalogue_Router::RouterMode::RAPTOR;
+    }
+    else
+    {
+        out.mode = TransportCatalogue_Router::RouterMode::ALL_PAIRS;
+    }
+
+    if (settings->graph_model() == transport_catalogue_serialize::Graph_Model::LINEAR)
+    {
+        out.graph_model = TransportCatalogue_Router::GraphModel::LINEAR;
+    }
+
     return out;
 }
 
@@ -530,31 +767,17 @@ graph::DirectedWeightedGraph<TransportCatalogue_Router::GraphBuilder::RouterWeig
 {
     graph::DirectedWeightedGraph<TransportCatalogue_Router::GraphBuilder::RouterWeight>::InitStruct out;
 
-    for (int i = 0; i < std::max({proto_graph->edges_size(), proto_graph->incidence_lists_size()}); ++i)
-    {
-        if ( i < proto_graph->edges_size())
-        {
-            graph::Edge<TransportCatalogue_Router::GraphBuilder::RouterWeight> edge_in;
-
-            auto& proto_edge = proto_graph->edges(i);
-
-            edge_in.from = proto_edge.from();
-            edge_in.to = proto_edge.to();
-            edge_in.weight.weight = proto_edge.weight();
-
-            out.edges.push_back(std::move(edge_in));
+    out.vertex_count = proto_graph->vertex_count() != 0 ? proto_graph->vertex_count() : proto_graph->incidence_lists_size();
 
-        }
-
-        if (i < proto_graph->incidence_lists_size())
-        {
-            out.incidence_lists.emplace_back();
+    out.edges.reserve(proto_graph->edges_size());
+    for (const auto& proto_edge : proto_graph->edges())
+    {
+        graph::Edge<TransportCatalogue_Router::GraphBuilder::RouterWeight> edge_in;
+        edge_in.from = proto_edge.from();
+        edge_in.to = proto_edge.to();
+        edge_in.weight.weight = proto_edge.weight();
 
-            for (auto value : proto_graph->incidence_lists(i).edge_id_list())
-            {
-                out.incidence_lists.back().push_back(value);
-            }
-        }
+        out.edges.push_back(std::move(edge_in));
     }
 
     return out;
@@ -567,15 +790,33 @@ TransportCatalogue_Router::GraphBuilder::InitStruct Deserealization::CreateGraph
     out.settings = settings;
     out.graph = CreateDWGraphInit(proto_puilder->mutable_graph());
 
-    for (auto& value : *proto_puilder->mutable_edgels())
+    if (proto_puilder->edge_owner_ids_size() != proto_puilder->edge_span_counts_size())
+    {
+        throw std::runtime_error("deserialization error: broken edge metadata");
+    }
+
+    out.edgels.reserve(proto_puilder->edge_owner_ids_size() + proto_puilder->edgels_size());
+    for (int i = 0; i < proto_puilder->edge_owner_ids_size(); ++i)
+    {
+        out.edgels.push_back({proto_puilder->edge_owner_ids(i), static_cast<uint16_t>(proto_puilder->edge_span_counts(i))});
+    }
+
+    // в базах прежних версий у ребра имя остановки или маршрута вместо номера
+    for (const auto& value : proto_puilder->edgels())
     {
         TransportCatalogue_Router::GraphBuilder::EdgeID edge_id_in;
+        edge_id_in.span_count = static_cast<uint16_t>(value.span_count());
 
-        edge_id_in.name = std::move(*value.mutable_name());
-        edge_id_in.span_count = value.span_count();
-        edge_id_in.weight = value.weight();
+        if (value.span_count() == 0)
+        {
+            edge_id_in.owner_id = static_cast<uint32_t>(fields_.stops_index_table_.at(value.name())->id);
+        }
+        else
+        {
+            edge_id_in.owner_id = static_cast<uint32_t>(fields_.bus_index_table_.at(value.name())->id);
+        }
 
-        out.edgels.push_back(std::move(edge_id_in));
+        out.edgels.push_back(edge_id_in);
     }
 
     return out;
@@ -584,31 +825,50 @@ TransportCatalogue_Router::GraphBuilder::InitStruct Deserealization::CreateGraph
 graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>::InitStruct Deserealization::CreateRouterInit(transport_catalogue_serialize::Router* proto_router)
 {
     graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>::InitStruct out;
+    auto& routes_data = out.routes_internal_data;
 
-    for (auto& value_d1 : *proto_router->mutable_routes_data())
+    if (proto_router->vertex_count() == 0 && proto_router->routes_data_size() != 0)
     {
-        out.routes_internal_data.emplace_back();
+        ReadLegacyRoutes(*proto_router, routes_data);
+        return out;
+    }
 
-        for (auto& value_d2 : *value_d1.mutable_data_list())
-        {
-            if (value_d2.has_data())
-            {
-                if (value_d2.data().has_prev_edge())
-                {
-                    graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>::RouteInternalData data_in{value_d2.data().weight(), value_d2.data().prev_edge().data()};
-                    out.routes_internal_data.back().push_back(data_in);
-                }
-                else
-                {
-                    graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>::RouteInternalData data_in{value_d2.data().weight(), std::nullopt};
-                    out.routes_internal_data.back().push_back(data_in);
-                }
-            }
-            else
-            {
-                out.routes_internal_data.back().emplace_back(std::nullopt);
-            }
-        }
+    routes_data.vertex_count = proto_router->vertex_count();
+    routes_data.weights.resize(routes_data.vertex_count * routes_data.vertex_count);
+    routes_data.prev_edges.resize(routes_data.vertex_count * routes_data.vertex_count);
+
+    ReadPacked(proto_router->weights(), routes_data.weights);
+    ReadPacked(proto_router->prev_edges(), routes_data.prev_edges);
+
+    return out;
+}
+
+graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>::InitStruct Deserealization::CreateRouterInit(const BaseImageRoutes& image_routes)
+{
+    using RouterWeight = TransportCatalogue_Router::GraphBuilder::RouterWeight;
+
+    // таблица не копируется: Router читает ее из отображенного файла и удерживает отображение
+    graph::Router<RouterWeight>::InitStruct out;
+    out.external_routes = {image_routes.vertex_count, reinterpret_cast<const RouterWeight*>(image_routes.weights), image_routes.prev_edges};
+    out.external_storage = mapped_file_;
+
+    return out;
+}
+
+graph::ContractionHierarchiesRouter<TransportCatalogue_Router::GraphBuilder::RouterWeight>::InitStruct Deserealization::CreateContractionHierarchiesInit(transport_catalogue_serialize::ContractionHierarchies* proto_ch)
+{
+    graph::ContractionHierarchiesRouter<TransportCatalogue_Router::GraphBuilder::RouterWeight>::InitStruct out;
+
+    out.ranks.reserve(proto_ch->ranks_size());
+    for (const auto rank : proto_ch->ranks())
+    {
+        out.ranks.push_back(rank);
+    }
+
+    out.shortcuts.reserve(proto_ch->shortcuts_size());
+    for (const auto& proto_shortcut : proto_ch->shortcuts())
+    {
+        out.shortcuts.push_back({proto_shortcut.from(), proto_shortcut.to(), {proto_shortcut.weight()}, proto_shortcut.first_edge(), proto_shortcut.second_edge()});
     }
 
     return out;
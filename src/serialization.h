@@ -2,10 +2,13 @@
 
 #include "transport_catalogue.h"
 #include "json_reader.h"
+#include "base_image.h"
 
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <optional>
 
 #include "transport_catalogue.pb.h"
 
@@ -23,32 +26,38 @@ public:
     Serealization(const TransportCatalogue& catalog);
     
     void RunSerealization(std::ostream& output);
+    // образ базы для отображения в память, см. base_image.h
+    void RunSerealizationImage(std::ostream& output);
 
     void SetMapSettings(const Interfaces::MapRenderer::RenderSetting* settings);
     void SetRouterSettings(const TransportCatalogue_Router::RouterSettings* settings);
     void SetGraphBuilder(const TransportCatalogue_Router::GraphBuilder* builder);
     void SetRouter(const graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>* router);
+    void SetContractionHierarchies(const graph::ContractionHierarchiesRouter<TransportCatalogue_Router::GraphBuilder::RouterWeight>* ch_router);
 
 private:
 
     using DWGraph = graph::DirectedWeightedGraph<TransportCatalogue_Router::GraphBuilder::RouterWeight>;
+    using CHRouter = graph::ContractionHierarchiesRouter<TransportCatalogue_Router::GraphBuilder::RouterWeight>;
 
     DB_Worker::Serealiz_TC_Fields fields_;
     const TransportCatalogue_Router::RouterSettings* router_settings_ = nullptr;
     const Interfaces::MapRenderer::RenderSetting* map_settings_ = nullptr;
     const TransportCatalogue_Router::GraphBuilder* graph_builder_ptr_ = nullptr;
     const graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>* router_ptr_ = nullptr;
+    const CHRouter* ch_router_ptr_ = nullptr;
 
-    transport_catalogue_serialize::TransportCatalogue CreateProtoTransportCatalogue() const;
+    transport_catalogue_serialize::TransportCatalogue CreateProtoTransportCatalogue(bool with_routes_table = true) const;
     transport_catalogue_serialize::Stop CreateProtoStop(const domain::Stop& stop) const;
     transport_catalogue_serialize::Bus CreateProtoBus(const domain::Bus& bus) const;
-    transport_catalogue_serialize::StopToStop CreateProtoStopToStop(const domain::Stop* from, const domain::Stop* to, unsigned int lenght) const;
+    transport_catalogue_serialize::StopToStop CreateProtoStopToStop(size_t from_id, size_t to_id, unsigned int lenght) const;
 
     transport_catalogue_serialize::RenderSettings CreateProtoRenderSettings() const;
     transport_catalogue_serialize::RouterSettings CreateProtoRouterSettings(TransportCatalogue_Router::RouterSettings settings) const;
     transport_catalogue_serialize::DirectedWeightedGraph CreateProtoDWGraph(const DWGraph& graph) const;
     transport_catalogue_serialize::GraphBuilder CreateProtoGraphBuilder() const;
     transport_catalogue_serialize::Router CreateProtoRouter() const;
+    transport_catalogue_serialize::ContractionHierarchies CreateProtoContractionHierarchies() const;
     transport_catalogue_serialize::Color CreateProtoColor(const svg::Color& color_in) const;
 }; // end class Serealization
 
@@ -60,19 +69,26 @@ public:
 
     void RunDeserealization(std::istream& input);
     void RunDeserealization(std::istream& input, Interfaces::JsonReader& reader);
+    // отображает файл в память и читает его в любом из форматов - protobuf или образ базы
+    void RunDeserealization(const Path& file, Interfaces::JsonReader& reader);
 
 private:
 
     DB_Worker::Deserealiz_TC_Fields fields_;
     transport_catalogue_serialize::TransportCatalogue desed_catalog_;
+    std::shared_ptr<const MappedFile> mapped_file_;
+    std::optional<BaseImageRoutes> image_routes_;
 
     void DeserealizationTC(std::istream& input);
+    void FeedReader(Interfaces::JsonReader& reader);
 
     Interfaces::MapRenderer::RenderSetting CreateMapRenderSettings(transport_catalogue_serialize::RenderSettings& settings);
     graph::DirectedWeightedGraph<TransportCatalogue_Router::GraphBuilder::RouterWeight>::InitStruct CreateDWGraphInit(transport_catalogue_serialize::DirectedWeightedGraph* proto_graph);
     TransportCatalogue_Router::RouterSettings CreateRouterSettings(transport_catalogue_serialize::RouterSettings* settings);
     TransportCatalogue_Router::GraphBuilder::InitStruct CreateGraphBuilderInit(TransportCatalogue_Router::RouterSettings&& settings, transport_catalogue_serialize::GraphBuilder* proto_puilder);
     graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>::InitStruct CreateRouterInit(transport_catalogue_serialize::Router* proto_router);
+    graph::Router<TransportCatalogue_Router::GraphBuilder::RouterWeight>::InitStruct CreateRouterInit(const BaseImageRoutes& image_routes);
+    graph::ContractionHierarchiesRouter<TransportCatalogue_Router::GraphBuilder::RouterWeight>::InitStruct CreateContractionHierarchiesInit(transport_catalogue_serialize::ContractionHierarchies* proto_ch);
     void FeedTCFieds();
     std::vector<domain::Stop*> FeedStops(google::protobuf::RepeatedPtrField<transport_catalogue_serialize::Stop>* stops_arr);
     void FeedFields(google::protobuf::RepeatedPtrField<transport_catalogue_serialize::Bus>* bus_arr, google::protobuf::RepeatedPtrField<transport_catalogue_serialize::StopToStop>* length_arr, std::vector<domain::Stop*>&& stops_id_index);
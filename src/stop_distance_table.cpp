@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "stop_distance_table.h"
+
+namespace distance_table
+{
+
+bool StopDistanceTable::Insert(size_t from, size_t to, unsigned int length)
+{
+    // заполнение не больше половины, цепочки пробирования остаются короткими
+    if ((size_ + 1) * 2 > slots_.size())
+    {
+        Rehash(std::max(MIN_CAPACITY, slots_.size() * 2));
+    }
+
+    const uint64_t key = MakeKey(from, to);
+    Slot& slot = slots_[FindSlot(key)];
+    if (slot.key == key)
+    {
+        return false;
+    }
+    slot = {key, length};
+    ++size_;
+    return true;
+}
+
+std::optional<unsigned int> StopDistanceTable::Find(size_t from, size_t to) const
+{
+    if (size_ == 0)
+    {
+        return std::nullopt;
+    }
+    const uint64_t key = MakeKey(from, to);
+    const Slot& slot = slots_[FindSlot(key)];
+    if (slot.key != key)
+    {
+        return std::nullopt;
+    }
+    return slot.length;
+}
+
+unsigned int StopDistanceTable::GetLength(size_t from, size_t to) const
+{
+    if (const auto length = Find(from, to))
+    {
+        return *length;
+    }
+    return Find(to, from).value_or(0);
+}
+
+void StopDistanceTable::Reserve(size_t count)
+{
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < count * 2)
+    {
+        capacity *= 2;
+    }
+    if (capacity > slots_.size())
+    {
+        Rehash(capacity);
+    }
+}
+
+size_t StopDistanceTable::GetSize() const
+{
+    return size_;
+}
+
+uint64_t StopDistanceTable::MakeKey(size_t from, size_t to)
+{
+    if (from > 0xFFFFFFFEu || to > 0xFFFFFFFEu)
+    {
+        throw std::length_error("Stop id is too large for the distance table");
+    }
+    return (static_cast<uint64_t>(from) << 32) | static_cast<uint64_t>(to);
+}
+
+uint64_t StopDistanceTable::Mix(uint64_t key)
+{
+    key ^= key >> 30;
+    key *= 0xBF58476D1CE4E5B9ull;
+    key ^= key >> 27;
+    key *= 0x94D049BB133111EBull;
+    key ^= key >> 31;
+    return key;
+}
+
+// ячейка с ключом key или первая пустая ячейка его цепочки
+size_t StopDistanceTable::FindSlot(uint64_t key) const
+{
+    const size_t mask = slots_.size() - 1;
+    size_t index = static_cast<size_t>(Mix(key)) & mask;
+    while (slots_[index].key != key && slots_[index].key != EMPTY_KEY)
+    {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+void StopDistanceTable::Rehash(size_t capacity)
+{
+    std::vector<Slot> old_slots(capacity, Slot{EMPTY_KEY, 0});
+    old_slots.swap(slots_);
+    for (const Slot& slot : old_slots)
+    {
+        if (slot.key != EMPTY_KEY)
+        {
+            slots_[FindSlot(slot.key)] = slot;
+        }
+    }
+}
+
+} // end namespace distance_table
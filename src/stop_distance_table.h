@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace distance_table
+{
+
+// Расстояния между парами остановок в плоской таблице с открытой адресацией.
+// Ключ - номера остановок from и to, упакованные в uint64_t. Хэш перемешивает все биты ключа
+// (финализатор splitmix64), поэтому пары (a, b) и (b, a) и соседние номера не скучиваются.
+// Поиск - линейное пробирование по непрерывному массиву, без узлов и выделений памяти
+class StopDistanceTable
+{
+public:
+    StopDistanceTable() = default;
+
+    // расстояние сохраняется, только если для пары его еще нет, возвращает true, если сохранено
+    bool Insert(size_t from, size_t to, unsigned int length);
+    std::optional<unsigned int> Find(size_t from, size_t to) const;
+    // расстояние from -> to, если его нет - to -> from, если нет и его - 0
+    unsigned int GetLength(size_t from, size_t to) const;
+
+    void Reserve(size_t count);
+    size_t GetSize() const;
+
+    // обходит сохраненные пары в порядке ячеек таблицы: func(from, to, length)
+    template <typename Func>
+    void ForEach(Func&& func) const
+    {
+        for (const Slot& slot : slots_)
+        {
+            if (slot.key != EMPTY_KEY)
+            {
+                func(static_cast<size_t>(slot.key >> 32), static_cast<size_t>(slot.key & 0xFFFFFFFFu), slot.length);
+            }
+        }
+    }
+
+private:
+    struct Slot
+    {
+        uint64_t key;
+        unsigned int length;
+    };
+
+    static constexpr uint64_t EMPTY_KEY = ~uint64_t{0};
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+
+    static uint64_t MakeKey(size_t from, size_t to);
+    static uint64_t Mix(uint64_t key);
+    size_t FindSlot(uint64_t key) const;
+    void Rehash(size_t capacity);
+}; // end class StopDistanceTable
+
+} // end namespace distance_table
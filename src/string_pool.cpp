@@ -0,0 +1,55 @@
+#include <cstring>
+
+#include "string_pool.h"
+
+namespace string_pool
+{
+
+std::string_view StringPool::Intern(std::string_view value)
+{
+    const auto iter = strings_.find(value);
+    if (iter != strings_.end())
+    {
+        return *iter;
+    }
+
+    const std::string_view stored = Store(value);
+    strings_.insert(stored);
+    return stored;
+}
+
+size_t StringPool::GetSize() const
+{
+    return strings_.size();
+}
+
+std::string_view StringPool::Store(std::string_view value)
+{
+    if (value.empty())
+    {
+        return {};
+    }
+
+    if (value.size() > block_free_)
+    {
+        // длинная строка получает собственный блок, текущий блок остается открытым
+        if (value.size() > BLOCK_SIZE / 4)
+        {
+            blocks_.push_back(std::make_unique<char[]>(value.size()));
+            std::memcpy(blocks_.back().get(), value.data(), value.size());
+            return {blocks_.back().get(), value.size()};
+        }
+
+        blocks_.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+        block_cursor_ = blocks_.back().get();
+        block_free_ = BLOCK_SIZE;
+    }
+
+    std::memcpy(block_cursor_, value.data(), value.size());
+    const std::string_view stored(block_cursor_, value.size());
+    block_cursor_ += value.size();
+    block_free_ -= value.size();
+    return stored;
+}
+
+} // end namespace string_pool
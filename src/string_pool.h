@@ -0,0 +1,37 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace string_pool
+{
+
+// Пул интернированных строк. Строки лежат подряд в крупных блоках, которые не перемещаются,
+// поэтому возвращаемые string_view действительны до разрушения пула.
+// Одинаковые строки хранятся один раз
+class StringPool
+{
+public:
+    StringPool() = default;
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    std::string_view Intern(std::string_view value);
+
+    size_t GetSize() const;
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t block_free_ = 0;
+    char* block_cursor_ = nullptr;
+    std::unordered_set<std::string_view> strings_;
+
+    std::string_view Store(std::string_view value);
+}; // end class StringPool
+
+} // end namespace string_pool
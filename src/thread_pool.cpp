@@ -0,0 +1,109 @@
+#include <algorithm>
+
+#include "thread_pool.h"
+
+namespace thread_pool
+{
+
+ThreadPool::ThreadPool(size_t thread_count)
+{
+    const size_t worker_count = thread_count > 1 ? thread_count - 1 : 0;
+    workers_.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i)
+    {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    task_cv_.notify_all();
+
+    for (auto& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::GetThreadCount() const
+{
+    return workers_.size() + 1;
+}
+
+void ThreadPool::Run(std::function<void(size_t, size_t)>&& task, size_t count, size_t block_size)
+{
+    {
+        std::lock_guard lock(mutex_);
+        task_ = std::move(task);
+        count_ = count;
+        block_size_ = block_size;
+        next_block_ = 0;
+        active_workers_ = workers_.size();
+        error_ = nullptr;
+        ++generation_;
+    }
+    task_cv_.notify_all();
+
+    RunBlocks();
+
+    std::unique_lock lock(mutex_);
+    done_cv_.wait(lock, [this] { return active_workers_ == 0; });
+    task_ = nullptr;
+
+    if (error_)
+    {
+        std::rethrow_exception(error_);
+    }
+}
+
+void ThreadPool::RunBlocks()
+{
+    const size_t block_count = (count_ + block_size_ - 1) / block_size_;
+    for (size_t block = next_block_++; block < block_count; block = next_block_++)
+    {
+        const size_t begin = block * block_size_;
+        try
+        {
+            task_(begin, std::min(count_, begin + block_size_));
+        }
+        catch (...)
+        {
+            std::lock_guard lock(mutex_);
+            if (!error_)
+            {
+                error_ = std::current_exception();
+            }
+        }
+    }
+}
+
+void ThreadPool::WorkerLoop()
+{
+    uint64_t seen_generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock lock(mutex_);
+            task_cv_.wait(lock, [this, seen_generation] { return stop_ || generation_ != seen_generation; });
+            if (stop_)
+            {
+                return;
+            }
+            seen_generation = generation_;
+        }
+
+        RunBlocks();
+
+        std::lock_guard lock(mutex_);
+        if (--active_workers_ == 0)
+        {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+} // end namespace thread_pool
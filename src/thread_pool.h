@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace thread_pool
+{
+
+// Пул потоков для параллельных циклов. ParallelFor делит диапазон [0, count) на блоки,
+// раздает их рабочим потокам и вызывающему потоку и возвращается, когда обработаны все блоки
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // число потоков с учетом вызывающего
+    size_t GetThreadCount() const;
+
+    // func(begin, end) вызывается для каждого блока, блоки обрабатываются в произвольном порядке
+    template <typename Func>
+    void ParallelFor(size_t count, size_t block_size, Func&& func);
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable task_cv_;
+    std::condition_variable done_cv_;
+
+    std::function<void(size_t, size_t)> task_;
+    size_t count_ = 0;
+    size_t block_size_ = 1;
+    std::atomic<size_t> next_block_{0};
+    size_t active_workers_ = 0;
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+
+    void WorkerLoop();
+    void RunBlocks();
+    void Run(std::function<void(size_t, size_t)>&& task, size_t count, size_t block_size);
+}; // end class ThreadPool
+
+template <typename Func>
+void ThreadPool::ParallelFor(size_t count, size_t block_size, Func&& func)
+{
+    if (block_size == 0)
+    {
+        block_size = 1;
+    }
+
+    if (workers_.empty() || count <= block_size)
+    {
+        for (size_t begin = 0; begin < count; begin += block_size)
+        {
+            func(begin, std::min(count, begin + block_size));
+        }
+        return;
+    }
+
+    Run(std::function<void(size_t, size_t)>(std::forward<Func>(func)), count, block_size);
+}
+
+} // end namespace thread_pool
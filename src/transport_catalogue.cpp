@@ -5,10 +5,11 @@ namespace NS_TransportCatalogue
     using namespace domain;
 void TransportCatalogue::AddStop(Stop&& input) 
 {
-    auto iter = stops_base_.insert(stops_base_.end(), std::move(input));
-    iter->id = (stops_base_.size() - 1);
-    stops_index_table_[iter->name] = &(*iter);
-    bus_throw_stop_[&(*iter)];
+    Stop& stop = stops_base_.emplace_back(std::move(input));
+    stop.name = names_.Intern(stop.name);
+    stop.id = (stops_base_.size() - 1);
+    stops_index_table_[stop.name] = &stop;
+    bus_throw_stop_[&stop];
 } // AddStop
 
 
@@ -18,14 +19,28 @@ void TransportCatalogue::AddStop(std::list<Stop>&& input_stops, std::list<std::p
     }
     
     for (auto& stop_to_stop : root_length) {
-        auto iter = stops_index_table_.find(stop_to_stop.first);
         for (auto& to_stop : stop_to_stop.second) {
-            auto iter2 = stops_index_table_.find(to_stop.first);
-            length_stop_to_neighbor_.insert({{iter->second, iter2->second}, to_stop.second});
+            AddDistance(stop_to_stop.first, to_stop.first, to_stop.second);
         }
     }
 } // AddStop container input
 
+void TransportCatalogue::AddDistance(std::string_view from, std::string_view to, unsigned int length)
+{
+    const auto iter_from = stops_index_table_.find(from);
+    const auto iter_to = stops_index_table_.find(to);
+    if (iter_from == stops_index_table_.end() || iter_to == stops_index_table_.end())
+    {
+        throw std::invalid_argument("Stop - " + std::string{iter_from == stops_index_table_.end() ? from : to} + " - not found");
+    }
+    length_stop_to_neighbor_.Insert(iter_from->second->id, iter_to->second->id, length);
+} // AddDistance
+
+std::string_view TransportCatalogue::InternName(std::string_view name)
+{
+    return names_.Intern(name);
+} // InternName
+
 std::optional<TransportCatalogue::StopOutput> TransportCatalogue::GetStop(std::string_view name) const noexcept 
 {
     const auto iter = stops_index_table_.find(name);
@@ -59,7 +74,7 @@ void TransportCatalogue::AddBus(BusInput&& input)
 {
     size_t index_val = 0;
     double distance = 0;
-    auto iter_bus = bus_base_.insert(bus_base_.end(), {std::move(input.name), std::vector<const Stop*>{}, distance, input.type});
+    Bus* iter_bus = &bus_base_.emplace_back(Bus{names_.Intern(input.name), std::vector<const Stop*>{}, distance, input.type});
     iter_bus->id = (bus_base_.size() - 1);
     iter_bus->stops.reserve(input.stops.size());
     
@@ -68,34 +83,46 @@ void TransportCatalogue::AddBus(BusInput&& input)
         
         if (iter == stops_index_table_.end()) 
         {
-            bus_base_.erase(iter_bus);
+            bus_base_.pop_back();
             throw std::invalid_argument("Stop - " + std::string{stop} + " - not found");
         }
         
         iter_bus->stops.push_back(iter->second);
         iter_bus->distance += index_val > 0 ? geo::ComputeDistance(iter_bus->stops[index_val - 1]->coordinates, iter_bus->stops[index_val]->coordinates) : 0;
         ++index_val;
-        bus_index_table_.insert({iter_bus->name, &(*iter_bus)});
+        bus_index_table_.insert({iter_bus->name, iter_bus});
         bus_throw_stop_[iter->second].insert(iter_bus->name);
     }
+
+    ComputeHopLengths(*iter_bus);
+    iter_bus->stats = ComputeBusStats(*iter_bus);
 } // AddBus
 
 unsigned int TransportCatalogue::CheckRouteLength(const Stop* stop, const Stop* stop_next) const
 {
-    auto stop_to_nei = length_stop_to_neighbor_.find({stop, stop_next});
-    if (stop_to_nei != length_stop_to_neighbor_.end())
+    return length_stop_to_neighbor_.GetLength(stop->id, stop_next->id);
+} // CheckRouteLength
+
+void TransportCatalogue::ComputeHopLengths(Bus& bus) const
+{
+    const auto& stops = bus.stops;
+    const size_t hop_count = stops.empty() ? 0 : stops.size() - 1;
+
+    bus.hop_lengths.resize(hop_count);
+    for (size_t i = 0; i < hop_count; ++i)
     {
-        return stop_to_nei->second;
+        bus.hop_lengths[i] = CheckRouteLength(stops[i], stops[i + 1]);
     }
-    else
+
+    bus.reverse_hop_lengths.clear();
+    if (bus.root_type == BussRootType::FORWARD)
     {
-        stop_to_nei = length_stop_to_neighbor_.find({stop_next, stop});
-        if (stop_to_nei != length_stop_to_neighbor_.end())
+        bus.reverse_hop_lengths.resize(hop_count);
+        for (size_t i = 0; i < hop_count; ++i)
         {
-            return stop_to_nei->second;
+            bus.reverse_hop_lengths[i] = CheckRouteLength(stops[i + 1], stops[i]);
         }
     }
-    return 0;
 } // CheckRouteLength
 
 std::optional<TransportCatalogue::BusOutput> TransportCatalogue::GetBus(std::string_view name) const 
@@ -104,52 +131,57 @@ std::optional<TransportCatalogue::BusOutput> TransportCatalogue::GetBus(std::str
     if (iter == bus_index_table_.end()) 
         return std::nullopt;
     std::vector<std::string_view> stops_vec;
-    std::vector<unsigned int> lengt_vec;
     stops_vec.reserve(iter->second->stops.size());
-    lengt_vec.reserve(iter->second->stops.size() * 2);
+    for (const Stop* stop : iter->second->stops)
+    {
+        stops_vec.push_back(stop->name);
+    }
+    return TransportCatalogue::BusOutput{iter->second->name, std::move(stops_vec), iter->second->stats.route_length, iter->second->stats.curvature, iter->second->root_type};
+} // GetBus
 
-    if (iter->second->root_type == BussRootType::CYCLE)
+std::optional<BusStats> TransportCatalogue::GetBusStats(std::string_view name) const
+{
+    const auto iter = bus_index_table_.find(name);
+    if (iter == bus_index_table_.end())
     {
-        for (auto i = iter->second->stops.begin(); i < iter->second->stops.end(); ++i)
-        {
-            stops_vec.push_back((*i)->name);
-            if (std::next(i) != iter->second->stops.end()) 
-            {
-                lengt_vec.push_back(CheckRouteLength(*i, *std::next(i)));
-            }
-        }
+        return std::nullopt;
     }
-    else if (iter->second->root_type == BussRootType::FORWARD)
+    return iter->second->stats;
+} // GetBusStats
+
+BusStats TransportCatalogue::ComputeBusStats(const Bus& bus) const
+{
+    BusStats stats;
+    stats.distance = bus.distance;
+
+    // длины перегонов уже посчитаны ComputeHopLengths
+    const auto& stops = bus.stops;
+    unsigned int length = std::accumulate(bus.hop_lengths.begin(), bus.hop_lengths.end(), 0u);
+
+    // маршрут FORWARD проходится туда и обратно, к нему добавляется расстояние от конечной до самой себя
+    if (bus.root_type == BussRootType::FORWARD)
     {
-        auto fi = iter->second->stops.begin();
-        auto ri = iter->second->stops.rbegin();
-        for (; fi < iter->second->stops.end() && ri < iter->second->stops.rend(); ++fi, ++ri)
+        length = std::accumulate(bus.reverse_hop_lengths.begin(), bus.reverse_hop_lengths.end(), length);
+        if (!stops.empty())
         {
-            stops_vec.push_back((*fi)->name);
-            if (std::next(fi) != iter->second->stops.end() && std::next(ri) != iter->second->stops.rend())
-            {
-                lengt_vec.push_back(CheckRouteLength(*fi, *std::next(fi)));
-                lengt_vec.push_back(CheckRouteLength(*ri, *std::next(ri)));
-            }
-            else
-            {
-                lengt_vec.push_back(CheckRouteLength(*fi, *fi));
-            }
+            length += CheckRouteLength(stops.back(), stops.back());
         }
-    }
-    unsigned int length = 0;
-    length += std::accumulate(lengt_vec.begin(), lengt_vec.end(), 0);
-    double curvature = 0;
-    if (iter->second->root_type == BussRootType::FORWARD)
-    {
-        curvature = (length / 2) / iter->second->distance;
+        stats.curvature = (length / 2) / bus.distance;
+        stats.stop_count = static_cast<int>(stops.size()) * 2 - 1;
     }
     else
     {
-        curvature = length / iter->second->distance;
+        stats.curvature = length / bus.distance;
+        stats.stop_count = static_cast<int>(stops.size());
     }
-    return TransportCatalogue::BusOutput{iter->second->name, std::move(stops_vec), length, curvature, iter->second->root_type};
-} // GetBus
+    stats.route_length = length;
+
+    std::vector<const Stop*> unique_stops(stops.begin(), stops.end());
+    std::sort(unique_stops.begin(), unique_stops.end());
+    stats.unique_stop_count = static_cast<int>(std::unique(unique_stops.begin(), unique_stops.end()) - unique_stops.begin());
+
+    return stats;
+} // ComputeBusStats
 
 std::vector<const domain::Bus*> TransportCatalogue::GetBusVector() const
 {
@@ -169,15 +201,15 @@ size_t TransportCatalogue::GetBusCount() const
 {
     return bus_base_.size();
 }
-const std::list<Bus>& TransportCatalogue::GetBusList() const
+const TransportCatalogue::BusStorage& TransportCatalogue::GetBusList() const
 {
     return bus_base_;
 }
-std::list<Bus>::const_iterator TransportCatalogue::GetBusListBegin() const
+TransportCatalogue::BusStorage::const_iterator TransportCatalogue::GetBusListBegin() const
 {
     return bus_base_.begin();
 }
-std::list<Bus>::const_iterator TransportCatalogue::GetBusListEnd() const
+TransportCatalogue::BusStorage::const_iterator TransportCatalogue::GetBusListEnd() const
 {
     return bus_base_.end();
 }
@@ -187,17 +219,17 @@ size_t TransportCatalogue::GetStopCount() const
     return stops_base_.size();
 } // GetStopCount
 
-const std::list<Stop>& TransportCatalogue::GetStopList() const
+const TransportCatalogue::StopStorage& TransportCatalogue::GetStopList() const
 {
     return stops_base_;
 } // GetStopList
 
-std::list<Stop>::const_iterator TransportCatalogue::GetStopListBegin() const
+TransportCatalogue::StopStorage::const_iterator TransportCatalogue::GetStopListBegin() const
 {
     return stops_base_.begin();
 } // GetStopListBegin
 
-std::list<Stop>::const_iterator TransportCatalogue::GetStopListEnd() const
+TransportCatalogue::StopStorage::const_iterator TransportCatalogue::GetStopListEnd() const
 {
     return stops_base_.end();
 } // GetStopListEnd
@@ -13,7 +13,10 @@
 #include <numeric>
 #include <memory>
 
+#include "chunked_storage.h"
 #include "domain.h"
+#include "string_pool.h"
+#include "stop_distance_table.h"
 
 namespace NS_TransportCatalogue
 {
@@ -46,13 +49,19 @@ public:
         std::vector<std::string_view> buses_throw_stop;
     }; //struct StopInput
 
+    // Остановки и маршруты лежат в блоках по 1024 элемента: элементы не перемещаются при добавлении,
+    // указатели и string_view на них стабильны
+    using StopStorage = chunked_storage::ChunkedStorage<Stop>;
+    using BusStorage = chunked_storage::ChunkedStorage<Bus>;
+
 private:
 
-    std::list<Stop> stops_base_;
-    std::list<Bus> bus_base_;
+    string_pool::StringPool names_;
+    StopStorage stops_base_;
+    BusStorage bus_base_;
     std::unordered_map<std::string_view, Stop*> stops_index_table_;
     std::unordered_map<std::string_view, Bus*> bus_index_table_;
-    std::unordered_map<std::pair<const Stop*, const Stop*>, unsigned int, StopPairHasher> length_stop_to_neighbor_;
+    distance_table::StopDistanceTable length_stop_to_neighbor_;
     std::unordered_map<const Stop*, std::set<std::string_view>> bus_throw_stop_;
 
 
@@ -62,6 +71,10 @@ public:
 
     void AddStop(Stop&& input);
     void AddStop(std::list<Stop>&& input_stops, std::list<std::pair<std::string_view, std::vector<std::pair<std::string_view, unsigned int>>>>&& root_length);
+    // расстояние между уже добавленными остановками, повторное для той же пары не перезаписывается
+    void AddDistance(std::string_view from, std::string_view to, unsigned int length);
+    // копия строки в пуле имен базы, действительна все время жизни каталога
+    std::string_view InternName(std::string_view name);
 
     std::optional<TransportCatalogue::StopOutput> GetStop(std::string_view name) const noexcept;
     const Stop* GetStopPtr(std::string_view name) const;
@@ -69,19 +82,23 @@ public:
     void AddBus(BusInput&& input);
 
     std::optional<TransportCatalogue::BusOutput> GetBus(std::string_view name) const;
+    std::optional<BusStats> GetBusStats(std::string_view name) const;
+    BusStats ComputeBusStats(const Bus& bus) const;
 
     unsigned int CheckRouteLength(const Stop* stop, const Stop* stop_next) const;
+    // длины перегонов маршрута по таблице расстояний, см. Bus::hop_lengths
+    void ComputeHopLengths(Bus& bus) const;
 
     std::vector<const domain::Bus*> GetBusVector() const;
     size_t GetBusCount() const;
-    const std::list<Bus>& GetBusList() const;
-    std::list<Bus>::const_iterator GetBusListBegin() const;
-    std::list<Bus>::const_iterator GetBusListEnd() const;
+    const BusStorage& GetBusList() const;
+    BusStorage::const_iterator GetBusListBegin() const;
+    BusStorage::const_iterator GetBusListEnd() const;
     
     size_t GetStopCount() const;
-    const std::list<Stop>& GetStopList() const;
-    std::list<Stop>::const_iterator GetStopListBegin() const;
-    std::list<Stop>::const_iterator GetStopListEnd() const;
+    const StopStorage& GetStopList() const;
+    StopStorage::const_iterator GetStopListBegin() const;
+    StopStorage::const_iterator GetStopListEnd() const;
 }; // class TransportCatalogue
 
 class DB_Worker
@@ -96,24 +113,26 @@ protected:
 
     struct Deserealiz_TC_Fields
     {
-        std::list<Stop>& stops_base_;
-        std::list<Bus>& bus_base_;
+        string_pool::StringPool& names_;
+        TransportCatalogue::StopStorage& stops_base_;
+        TransportCatalogue::BusStorage& bus_base_;
         std::unordered_map<std::string_view, Stop*>& stops_index_table_;
         std::unordered_map<std::string_view, Bus*>& bus_index_table_;
-        std::unordered_map<std::pair<const Stop*, const Stop*>, unsigned int, StopPairHasher>& length_stop_to_neighbor_;
+        distance_table::StopDistanceTable& length_stop_to_neighbor_;
         std::unordered_map<const Stop*, std::set<std::string_view>>& bus_throw_stop_;
     };
 
     struct Serealiz_TC_Fields
     {
-        const std::list<Stop>& stops_base_;
-        const std::list<Bus>& bus_base_;
-        const std::unordered_map<std::pair<const Stop*, const Stop*>, unsigned int, StopPairHasher>& length_stop_to_neighbor_;
+        const TransportCatalogue::StopStorage& stops_base_;
+        const TransportCatalogue::BusStorage& bus_base_;
+        const distance_table::StopDistanceTable& length_stop_to_neighbor_;
     };
 
     Deserealiz_TC_Fields GetDeserealizFields()
     {
         return {
+                    catalog_.names_,
                     catalog_.stops_base_, 
                     catalog_.bus_base_,
                     catalog_.stops_index_table_, 
@@ -128,6 +147,16 @@ protected:
         return {catalog_.stops_base_, catalog_.bus_base_, catalog_.length_stop_to_neighbor_};
     }
 
+    void UpdateHopLengths(Bus& bus) const
+    {
+        catalog_.ComputeHopLengths(bus);
+    }
+
+    void UpdateBusStats(Bus& bus) const
+    {
+        bus.stats = catalog_.ComputeBusStats(bus);
+    }
+
 private:
     TransportCatalogue& catalog_;
 }; // end class DB_Worker
@@ -1,8 +1,44 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
 #include "transport_router.h"
 
 namespace NS_TransportCatalogue::TransportCatalogue_Router
 {
 
+namespace
+{
+
+struct EdgeKey
+{
+    graph::VertexId from;
+    graph::VertexId to;
+    std::string_view name;
+    int span_count;
+    double weight;
+
+    bool operator==(const EdgeKey& other) const
+    {
+        return from == other.from && to == other.to && name == other.name && span_count == other.span_count && weight == other.weight;
+    }
+};
+
+struct EdgeKeyHasher
+{
+    size_t operator()(const EdgeKey& key) const noexcept
+    {
+        size_t hash = std::hash<std::string_view>{}(key.name);
+        hash = hash * 37 + key.from;
+        hash = hash * 37 + key.to;
+        hash = hash * 37 + static_cast<size_t>(key.span_count);
+        return hash * 37 + std::hash<double>{}(key.weight);
+    }
+};
+
+} // end namespace
+
 GraphBuilder::RouterWeight GraphBuilder::RouterWeight::operator+(const RouterWeight& other) const
 {
     return {weight + other.weight};
@@ -19,19 +55,51 @@ bool GraphBuilder::RouterWeight::operator>(const RouterWeight& other) const
 }
 
 GraphBuilder::GraphBuilder(const NS_TransportCatalogue::TransportCatalogue& catalog, RouterSettings settings)
-    :catalog_(catalog), settings_(settings), graph_((catalog_.GetStopCount() * 2))
+    :catalog_(catalog), settings_(settings), graph_(GetVertexCount(catalog, settings.graph_model))
 {
-    Edgels_.reserve(catalog.GetStopCount() * 2);
-    AddVertex(catalog_.GetStopListBegin(), catalog.GetStopListEnd());
-
-    for (const auto& bus : catalog_.GetBusList())
+    if (settings_.graph_model == GraphModel::LINEAR)
+    {
+        // на каждый перегон цепочки посадка, высадка и переход к следующей вершине цепочки
+        Edgels_.reserve((graph_.GetVertexCount() - catalog_.GetStopCount()) * 3);
+        graph::VertexId first = catalog_.GetStopCount();
+        for (const auto& bus : catalog_.GetBusList())
+        {
+            CreateLinearBusRoute(bus, first);
+            first += GetChainVertexCount(bus);
+        }
+    }
+    else
     {
-        CreateBusRoute(bus);
+        Edgels_.reserve(catalog.GetStopCount() * 2);
+        AddVertex(catalog_.GetStopListBegin(), catalog.GetStopListEnd());
+
+        for (const auto& bus : catalog_.GetBusList())
+        {
+            CreateBusRoute(bus);
+        }
     }
+
+    // граф больше не меняется, маршрутизаторы обходят его в виде CSR
+    graph_.Freeze();
 }
 
 GraphBuilder::GraphBuilder(const NS_TransportCatalogue::TransportCatalogue& catalog, InitStruct&& init_data)
-    : catalog_(catalog), settings_(std::move(init_data.settings)), graph_(std::move(init_data.graph)), Edgels_(std::move(init_data.edgels)) {}
+    : catalog_(catalog), settings_(std::move(init_data.settings)), graph_(std::move(init_data.graph)), Edgels_(std::move(init_data.edgels))
+{
+    // метаданные ребер ссылаются в каталог по номерам: граф из другой или поврежденной базы
+    // отклоняется здесь, а не при выводе маршрута
+    if (Edgels_.size() != graph_.GetEdgeCount())
+    {
+        throw std::invalid_argument("Edge metadata does not match the graph");
+    }
+    for (const EdgeID& edge : Edgels_)
+    {
+        if (edge.owner_id >= (edge.span_count == 0 ? catalog_.GetStopCount() : catalog_.GetBusCount()))
+        {
+            throw std::invalid_argument("Graph edge refers to a missing stop or bus");
+        }
+    }
+}
 
 std::optional<unsigned int> GraphBuilder::GetBusID(std::string_view name) const
 {
@@ -40,6 +108,10 @@ std::optional<unsigned int> GraphBuilder::GetBusID(std::string_view name) const
     {
         return std::nullopt;
     }
+    if (settings_.graph_model == GraphModel::LINEAR)
+    {
+        return out->id;
+    }
     return (out->id * 2); // в векторе с ребрами, информация о ребрах вершин (вход-выход) хранится не симметрично их добавлению, хранится со смещением в 2 
 }
 
@@ -48,9 +120,21 @@ const graph::DirectedWeightedGraph<GraphBuilder::RouterWeight>& GraphBuilder::Ge
     return graph_;
 }
 
-GraphBuilder::EdgeID GraphBuilder::GetEdge(size_t id) const
+GraphBuilder::EdgeInfo GraphBuilder::GetEdge(size_t id) const
 {
-    return Edgels_[id];
+    const EdgeID& edge = Edgels_.at(id);
+    const std::string_view name = edge.span_count == 0 ? catalog_.GetStopList()[edge.owner_id].name : catalog_.GetBusList()[edge.owner_id].name;
+    return {name, edge.span_count, graph_.GetEdge(id).weight.weight};
+}
+
+void GraphBuilder::AddEdge(graph::VertexId from, graph::VertexId to, double weight, size_t owner_id, size_t span_count)
+{
+    if (owner_id > std::numeric_limits<uint32_t>::max() || span_count > std::numeric_limits<uint16_t>::max())
+    {
+        throw std::length_error("graph error: too many stops or buses for edge metadata");
+    }
+    graph_.AddEdge({from, to, weight});
+    Edgels_.push_back({static_cast<uint32_t>(owner_id), static_cast<uint16_t>(span_count)});
 }
 
 GraphBuilder::Data GraphBuilder::GetData() const
@@ -58,4 +142,138 @@ GraphBuilder::Data GraphBuilder::GetData() const
     return {settings_, graph_, Edgels_};
 }
 
+size_t GraphBuilder::GetChainVertexCount(const domain::Bus& bus)
+{
+    if (bus.stops.size() < 2)
+    {
+        return 0;
+    }
+    const size_t hop_count = bus.stops.size() - 1;
+    return bus.root_type == domain::BussRootType::FORWARD ? hop_count * 2 : hop_count;
+}
+
+size_t GraphBuilder::GetVertexCount(const NS_TransportCatalogue::TransportCatalogue& catalog, GraphModel model)
+{
+    if (model == GraphModel::SPAN_EDGES)
+    {
+        return catalog.GetStopCount() * 2;
+    }
+
+    size_t out = catalog.GetStopCount();
+    for (const auto& bus : catalog.GetBusList())
+    {
+        out += GetChainVertexCount(bus);
+    }
+    return out;
+}
+
+std::vector<graph::VertexId> GraphBuilder::GetChainBegins(const NS_TransportCatalogue::TransportCatalogue& catalog)
+{
+    std::vector<graph::VertexId> out;
+    out.reserve(catalog.GetBusCount());
+    graph::VertexId first = catalog.GetStopCount();
+    for (const auto& bus : catalog.GetBusList())
+    {
+        out.push_back(first);
+        first += GetChainVertexCount(bus);
+    }
+    return out;
+}
+
+graph::GraphMapping GraphBuilder::MapFrom(const GraphBuilder& previous) const
+{
+    graph::GraphMapping mapping;
+    mapping.vertices.assign(previous.graph_.GetVertexCount(), graph::GraphMapping::NO_VERTEX);
+    const bool is_linear = settings_.graph_model == GraphModel::LINEAR;
+    for (const auto& stop : previous.catalog_.GetStopList())
+    {
+        const domain::Stop* current = catalog_.GetStopPtr(stop.name);
+        if (current == nullptr)
+        {
+            continue;
+        }
+        if (is_linear)
+        {
+            mapping.vertices[stop.id] = current->id;
+        }
+        else
+        {
+            mapping.vertices[stop.id * 2] = current->id * 2;
+            mapping.vertices[stop.id * 2 + 1] = current->id * 2 + 1;
+        }
+    }
+
+    if (is_linear)
+    {
+        // цепочка сопоставляется целиком, если у маршрута те же тип и последовательность остановок
+        std::unordered_map<std::string_view, std::pair<const domain::Bus*, graph::VertexId>> chains;
+        const std::vector<graph::VertexId> begins = GetChainBegins(catalog_);
+        size_t index = 0;
+        for (const auto& bus : catalog_.GetBusList())
+        {
+            chains[bus.name] = {&bus, begins[index++]};
+        }
+
+        const std::vector<graph::VertexId> previous_begins = GetChainBegins(previous.catalog_);
+        index = 0;
+        for (const auto& bus : previous.catalog_.GetBusList())
+        {
+            const graph::VertexId previous_first = previous_begins[index++];
+            const auto iter = chains.find(bus.name);
+            if (iter == chains.end())
+            {
+                continue;
+            }
+
+            const domain::Bus& current = *iter->second.first;
+            const bool same_route = current.root_type == bus.root_type && std::equal(current.stops.begin(), current.stops.end(), bus.stops.begin(), bus.stops.end(),
+                [](const domain::Stop* lhs, const domain::Stop* rhs)
+                {
+                    return lhs->name == rhs->name;
+                });
+            if (!same_route)
+            {
+                continue;
+            }
+
+            for (size_t k = 0; k < GetChainVertexCount(bus); ++k)
+            {
+                mapping.vertices[previous_first + k] = iter->second.second + k;
+            }
+        }
+    }
+
+    // одинаковые ребра разбираются по возрастанию номеров, поэтому номера кладутся с конца
+    std::unordered_map<EdgeKey, std::vector<graph::EdgeId>, EdgeKeyHasher> edges_by_key;
+    edges_by_key.reserve(graph_.GetEdgeCount());
+    for (graph::EdgeId edge_id = graph_.GetEdgeCount(); edge_id-- > 0;)
+    {
+        const auto& edge = graph_.GetEdge(edge_id);
+        const EdgeInfo info = GetEdge(edge_id);
+        edges_by_key[{edge.from, edge.to, info.name, info.span_count, edge.weight.weight}].push_back(edge_id);
+    }
+
+    mapping.edges.assign(previous.graph_.GetEdgeCount(), graph::GraphMapping::NO_EDGE);
+    for (graph::EdgeId edge_id = 0; edge_id < previous.graph_.GetEdgeCount(); ++edge_id)
+    {
+        const auto& edge = previous.graph_.GetEdge(edge_id);
+        const graph::VertexId from = mapping.vertices[edge.from];
+        const graph::VertexId to = mapping.vertices[edge.to];
+        if (from == graph::GraphMapping::NO_VERTEX || to == graph::GraphMapping::NO_VERTEX)
+        {
+            continue;
+        }
+
+        const EdgeInfo info = previous.GetEdge(edge_id);
+        const auto iter = edges_by_key.find({from, to, info.name, info.span_count, edge.weight.weight});
+        if (iter != edges_by_key.end() && !iter->second.empty())
+        {
+            mapping.edges[edge_id] = iter->second.back();
+            iter->second.pop_back();
+        }
+    }
+
+    return mapping;
+}
+
 } // end namespace NS_TransportCatalogue::TransportCatalogue_Router
\ No newline at end of file
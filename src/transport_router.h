@@ -1,29 +1,50 @@
 #pragma once
 
 #include "router.h"
+#include "dijkstra_router.h"
+#include "contraction_hierarchies.h"
 #include "transport_catalogue.h"
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <iostream>
 
 namespace NS_TransportCatalogue::TransportCatalogue_Router
 {
 
+// RAPTOR - поиск по раундам прямо по маршрутам каталога, граф не строится, см. RaptorRouter
+enum class RouterMode {ALL_PAIRS, DIJKSTRA, CONTRACTION_HIERARCHIES, RAPTOR};
+
+// SPAN_EDGES - по ребру из каждой остановки маршрута в каждую следующую, O(L^2) ребер на маршрут
+// из L остановок. LINEAR - вершина "в автобусе" на каждую остановку маршрута, ребра только между
+// соседними остановками, O(L) ребер
+enum class GraphModel {SPAN_EDGES, LINEAR};
+
 struct RouterSettings
 {
     double bus_speed = 0;
     double bus_wait_time = 0;
+    RouterMode mode = RouterMode::ALL_PAIRS;
+    GraphModel graph_model = GraphModel::SPAN_EDGES;
 };
 
 class GraphBuilder
 {
-    template <typename Iter> class WeightCounter;
-    template <typename> friend class WeightCounter;
 public:
 
+    // Метаданные ребра: у ожидания (span_count == 0) owner_id - номер остановки, у поездки -
+    // номер маршрута. Имя берется из каталога, время - вес ребра графа
     struct EdgeID
     {
-        std::string name;
+        uint32_t owner_id = 0;
+        uint16_t span_count = 0;
+    };
+
+    // ребро с именем остановки или маршрута из каталога, для вывода маршрута
+    struct EdgeInfo
+    {
+        std::string_view name;
         int span_count = 0;
         double weight = 0;
     };
@@ -57,111 +78,99 @@ public:
     GraphBuilder(const NS_TransportCatalogue::TransportCatalogue& catalog, InitStruct&& init_data);
     const graph::DirectedWeightedGraph<RouterWeight>& GetGraphRef();
     std::optional<unsigned int> GetBusID(std::string_view name) const;
-    EdgeID GetEdge(size_t id) const;
+    EdgeInfo GetEdge(size_t id) const;
     Data GetData() const;
+    // соответствие графа previous, построенного по прежней версии базы, этому графу: остановки
+    // сопоставляются по имени, ребра - по концам, имени, числу пролетов и весу
+    graph::GraphMapping MapFrom(const GraphBuilder& previous) const;
 private:
 
+    // число вершин цепочки маршрута в линейной модели: по вершине на перегон каждого направления
+    static size_t GetChainVertexCount(const domain::Bus& bus);
+    static size_t GetVertexCount(const NS_TransportCatalogue::TransportCatalogue& catalog, GraphModel model);
+    // первые вершины цепочек маршрутов в линейной модели, в порядке GetBusList
+    static std::vector<graph::VertexId> GetChainBegins(const NS_TransportCatalogue::TransportCatalogue& catalog);
+
     const NS_TransportCatalogue::TransportCatalogue& catalog_;
     RouterSettings settings_;
     graph::DirectedWeightedGraph<RouterWeight> graph_;
     std::vector<EdgeID> Edgels_;
 
-    template <typename Iter>
+    // Накопленное время в пути по перегонам маршрута, длины перегонов берутся из массива
+    // маршрута (Bus::hop_lengths или reverse_hop_lengths) без поиска в таблице расстояний
     class WeightCounter
     {
-    private:
-        const GraphBuilder& graph_;
     public:
-        WeightCounter(const GraphBuilder& graph, Iter begin, Iter end):graph_(graph), cur_vertex(begin), end_vertex(end), next_vertex(begin) {}
+        WeightCounter(const GraphBuilder& graph, const std::vector<unsigned int>& hop_lengths): graph_(graph), hop_lengths_(hop_lengths) {}
 
-        double GetWeight()
+        double AddHop(size_t hop)
         {
-            ++next_vertex;
-            if (next_vertex == end_vertex)
-            {
-                return 0;
-            }
-            cur_weight += (graph_.catalog_.CheckRouteLength(*cur_vertex, *next_vertex)) / ((graph_.settings_.bus_speed * 1000) / 60);
-            ++cur_vertex;
-
+            cur_weight += graph_.GetRideTime(hop_lengths_[hop]);
             return cur_weight;
         }
 
-        double GetWeightReverse()
-        {
-            if (cur_vertex == end_vertex)
-            {
-                return 0;
-            }
-            --next_vertex;
-            cur_weight += (graph_.catalog_.CheckRouteLength(*cur_vertex, *next_vertex)) / ((graph_.settings_.bus_speed * 1000) / 60);
-            --cur_vertex;
-
-            return cur_weight;
-        }
-
-        Iter cur_vertex;
-        Iter end_vertex;
         double cur_weight = 0;
-        Iter next_vertex;
+
+    private:
+        const GraphBuilder& graph_;
+        const std::vector<unsigned int>& hop_lengths_;
     };
 
+    double GetRideTime(unsigned int length) const
+    {
+        return length / ((settings_.bus_speed * 1000) / 60);
+    }
+
+    void AddEdge(graph::VertexId from, graph::VertexId to, double weight, size_t owner_id, size_t span_count);
+
     template <typename Iter>
     void AddVertex(Iter begin, Iter end)
     {
         unsigned int i = 0;
         for (auto iter = begin; iter != end; ++iter)
         {
-            Edgels_.push_back({(*iter).name, 0, settings_.bus_wait_time});
-            graph_.AddEdge({i, i + 1, settings_.bus_wait_time});
+            AddEdge(i, i + 1, settings_.bus_wait_time, (*iter).id, 0);
             i += 2;
         }
     }
 
-    template <typename Iter>
-    void CreateRoundRoute(Iter iter_begin, Iter iter_end, std::string bus_name)
+    void CreateRoundRoute(const domain::Bus& bus)
     {
-        bool trig = true;
-        for (auto stop = iter_begin; stop < iter_end; ++stop)
+        const auto& stops = bus.stops;
+        for (size_t stop = 0; stop < stops.size(); ++stop)
         {
-            auto start_id = ((*stop)->id * 2) + 1;
-            
+            const graph::VertexId start_id = (stops[stop]->id * 2) + 1;
+
             int span_count = 1;
 
-            auto end_iter = trig ? iter_end - 1 : iter_end;
-            WeightCounter weight{*this, stop, end_iter};
+            // из первой остановки кольца ребро в нее же (конечную) не строится
+            const size_t end = stop == 0 ? stops.size() - 1 : stops.size();
+            WeightCounter weight{*this, bus.hop_lengths};
 
-            for (auto to_stop = stop + 1; to_stop < end_iter; ++to_stop)
+            for (size_t to_stop = stop + 1; to_stop < end; ++to_stop)
             {
-                auto to_stop_id = ((*to_stop)->id * 2);
-                graph_.AddEdge({start_id, to_stop_id, weight.GetWeight()});
-                Edgels_.push_back({bus_name, span_count++, weight.cur_weight});
+                AddEdge(start_id, stops[to_stop]->id * 2, weight.AddHop(to_stop - 1), bus.id, span_count++);
             }
-
-            trig = false;
         }
     }
 
-    template <typename Iter>
-    void CreateRoundtripRoute(Iter iter_begin, Iter iter_end, std::string bus_name)
+    void CreateRoundtripRoute(const domain::Bus& bus)
     {
-        for (auto stop_to_right = iter_begin, stop_to_left = iter_end - 1; stop_to_right < iter_end; ++stop_to_right, --stop_to_left)
+        const auto& stops = bus.stops;
+        for (size_t stop_to_right = 0; stop_to_right < stops.size(); ++stop_to_right)
         {
-            auto r_stop_id = ((*stop_to_right)->id * 2) + 1;
-            auto l_stop_id = ((*stop_to_left)->id * 2) + 1;
-            
+            const size_t stop_to_left = stops.size() - 1 - stop_to_right;
+            const graph::VertexId r_stop_id = (stops[stop_to_right]->id * 2) + 1;
+            const graph::VertexId l_stop_id = (stops[stop_to_left]->id * 2) + 1;
+
             int span_count = 1;
-            WeightCounter r_weight{*this, stop_to_right, iter_end};
-            WeightCounter l_weight{*this, stop_to_left, iter_begin};
+            WeightCounter r_weight{*this, bus.hop_lengths};
+            WeightCounter l_weight{*this, bus.reverse_hop_lengths};
 
-            for (auto to_r_stop = stop_to_right + 1, to_l_stop = stop_to_left - 1; to_r_stop < iter_end; ++to_r_stop, --to_l_stop)
+            for (size_t to_r_stop = stop_to_right + 1, to_l_stop = stop_to_left - 1; to_r_stop < stops.size(); ++to_r_stop, --to_l_stop)
             {
-                auto to_r_stop_id = ((*to_r_stop)->id * 2);
-                auto to_l_stop_id = ((*to_l_stop)->id * 2);
-                graph_.AddEdge({r_stop_id, to_r_stop_id, r_weight.GetWeight()});
-                graph_.AddEdge({l_stop_id, to_l_stop_id, l_weight.GetWeightReverse()});
-                Edgels_.push_back({bus_name, span_count, r_weight.cur_weight});
-                Edgels_.push_back({bus_name, span_count, l_weight.cur_weight});
+                AddEdge(r_stop_id, stops[to_r_stop]->id * 2, r_weight.AddHop(to_r_stop - 1), bus.id, span_count);
+                AddEdge(l_stop_id, stops[to_l_stop]->id * 2, l_weight.AddHop(to_l_stop), bus.id, span_count);
                 ++span_count;
             }
         }
@@ -171,11 +180,50 @@ private:
     {
         if (bus.root_type == domain::BussRootType::CYCLE)
         {
-            CreateRoundRoute(bus.stops.begin(), bus.stops.end(), bus.name);
+            CreateRoundRoute(bus);
         }
         else
         {
-            CreateRoundtripRoute(bus.stops.begin(), bus.stops.end(), bus.name);
+            CreateRoundtripRoute(bus);
+        }
+    }
+
+    // Цепочка линейной модели для одного направления маршрута: вершина first + k - пассажир в
+    // автобусе на k-й остановке направления. Ребро посадки из вершины остановки несет ожидание,
+    // перегон ведет либо в следующую вершину цепочки, либо сразу в вершину следующей остановки
+    void CreateChain(const domain::Bus& bus, graph::VertexId first, bool reversed)
+    {
+        const auto& stops = bus.stops;
+        const auto& hop_lengths = reversed ? bus.reverse_hop_lengths : bus.hop_lengths;
+        const size_t last = stops.size() - 1;
+        for (size_t k = 0; k < last; ++k)
+        {
+            const size_t stop = reversed ? last - k : k;
+            const size_t next_stop = reversed ? stop - 1 : stop + 1;
+            const graph::VertexId on_board = first + k;
+            const double ride_time = GetRideTime(hop_lengths[reversed ? next_stop : stop]);
+
+            AddEdge(stops[stop]->id, on_board, settings_.bus_wait_time, stops[stop]->id, 0);
+            AddEdge(on_board, stops[next_stop]->id, ride_time, bus.id, 1);
+            if (k + 1 < last)
+            {
+                AddEdge(on_board, on_board + 1, ride_time, bus.id, 1);
+            }
+        }
+    }
+
+    // направления маршрута FORWARD - отдельные цепочки, проехать конечную без пересадки нельзя
+    void CreateLinearBusRoute(const domain::Bus& bus, graph::VertexId first)
+    {
+        if (bus.stops.size() < 2)
+        {
+            return;
+        }
+
+        CreateChain(bus, first, false);
+        if (bus.root_type == domain::BussRootType::FORWARD)
+        {
+            CreateChain(bus, first + bus.stops.size() - 1, true);
         }
     }
 }; // end GraphBuilder